@@ -126,7 +126,8 @@ if not GetQuestID then
             -- Can't do anything about quest sharing currently, because we need the original questgiver's name to obtain quest ID, and we need quest ID to obtain the questgiver's name
             return questID
         else
-			questID = DataModules:GetQuestID(source, GetTitleText(), npcName, text) or 0
+			-- The zone quest hints know the quests given around the player without searching the data modules
+			questID = Addon:GetZoneQuestID(GetTitleText()) or DataModules:GetQuestID(source, GetTitleText(), npcName, text) or 0
 		end
 		
 		return questID
@@ -227,7 +228,7 @@ if Version:IsBelowLegacyVersion(60000) then
         end
         -- Patch 3.3.0 (2009-12-08): Added the 'questID' return.
         if Version:IsBelowLegacyVersion(30300) then
-            questID = DataModules:GetQuestID("accept", title, "", "")
+            questID = Addon:GetZoneQuestID(title) or DataModules:GetQuestID("accept", title, "", "")
             if not questID then
                 -- Try assuming that the last quest with the same title that the player has accepted is the quest that's currently in the quest log
                 questID = Addon.db.char.RecentQuestTitleToID[title]
@@ -368,6 +368,12 @@ end
 ---@return GUID|nil type `Enums.GUID` type of the quest giver
 ---@return number|nil id ID of the quest giver
 function DataModules:GetQuestLogQuestGiverTypeAndID(questID)
+    -- The zone quest hints sent by the server come first, they spare going through every module
+    local zoneQuest = Addon.ZoneQuests[questID]
+    if zoneQuest and zoneQuest.starter ~= "" then
+        return Utils:GetGUIDType(zoneQuest.starter), Utils:GetIDFromServerGUID(zoneQuest.starter)
+    end
+
     for _, module in self:GetModules() do
         local data = module.NPCIDLookupByQuestID
         if data then
@@ -447,6 +453,7 @@ local getFileNameForEvent =
 	end,
     [Enums.SoundEvent.QuestGreeting] = function(soundData) return DataModules:GetNPCGossipTextHash(soundData) end,
     [Enums.SoundEvent.Gossip]        = function(soundData) return DataModules:GetNPCGossipTextHash(soundData) end,
+    [Enums.SoundEvent.CreatureText]  = function(soundData) return soundData.textHash end,
 }
 setmetatable(getFileNameForEvent,
     {
@@ -459,11 +466,16 @@ setmetatable(getFileNameForEvent,
 ---@param soundData SoundData
 ---@return boolean found Whether the sound is found and can be played
 function DataModules:PrepareSound(soundData)
-    soundData.fileNames =
-	{	
-		getFileNameForEvent[soundData.event](soundData.questID, soundData.unitID),
-		getFileNameForEvent[soundData.event](soundData.questID, 0),
-	}
+    if Enums.SoundEvent:IsGossipEvent(soundData.event) then
+        -- Use the hash resolved by the server when there is one, it saves searching every gossip text of the NPC
+        soundData.fileNames = { soundData.textHash or getFileNameForEvent[soundData.event](soundData) }
+    else
+        soundData.fileNames =
+        {
+            getFileNameForEvent[soundData.event](soundData.questID, soundData.unitID),
+            getFileNameForEvent[soundData.event](soundData.questID, 0),
+        }
+    end
 
     for _, module in self:GetModules() do
 		local data = module.SoundLengthLookupByFileName
@@ -479,6 +491,7 @@ function DataModules:PrepareSound(soundData)
 					end
 					
 					if length then
+						soundData.fileName = fileName
 						soundData.filePath = format([[Interface\AddOns\%s\%s]], module.METADATA.AddonName,
 							module.GetSoundPath and module:GetSoundPath(fileName, soundData.event) or
 							fileName)
@@ -10,6 +10,7 @@ Enums.SoundEvent =
     QuestComplete = 3,
     QuestGreeting = 4,
     Gossip = 5,
+    CreatureText = 6, -- Say and yell lines of creatures, only pushed by the server along with their sound hash
 }
 ---@param event SoundEvent
 ---@return boolean isQuestEvent Is event related to a quest (`SoundData.questID` must be present)
@@ -17,11 +18,26 @@ function Enums.SoundEvent:IsQuestEvent(event)
     return event == self.QuestAccept or event == self.QuestProgress or event == self.QuestComplete
 end
 ---@param event SoundEvent
----@return boolean isGossipEvent Is event related to a gossip (`SoundData.text` must be present)
+---@return boolean isGossipEvent Is event related to a gossip (`SoundData.text` or `SoundData.textHash` must be present)
 function Enums.SoundEvent:IsGossipEvent(event)
-    return event == self.Gossip or event == self.QuestGreeting
+    return event == self.Gossip or event == self.QuestGreeting or event == self.CreatureText
 end
 
+---@enum AddonCapability
+--- Optional server protocol features requested in the `enableAddon` handshake, combined as bit flags
+Enums.AddonCapability =
+{
+    QuestLogSnapshot = 1,
+    CompactProtocol = 2, -- Protocol v2: base 36 numbers, one character giver types and no fields the client already knows
+    SoundEventPush = 4, -- The server sends the sound events along with the quest and gossip frames, without a request
+    QuestLogDeltas = 8, -- Quest log changes are numbered, a missed one is asked for instead of the whole quest log
+    AddonChannel = 16, -- Requests are whispered to the player's own character instead of sent as chat commands
+    BatchedMessages = 32, -- Several server messages can arrive in one addon message, separated by a "\30" character
+    CreatureTexts = 64, -- The server sends the voiced say and yell lines of the creatures in hearing range
+    ZoneQuestHints = 128, -- The server sends the voiced quests of the zone the player enters, with their givers and titles
+    QuestTextFingerprints = 256, -- Quest sound events send a fingerprint of the quest text, the server tells apart the quests sharing a title with them
+}
+
 ---@enum GossipFrequency
 Enums.GossipFrequency =
 {
@@ -71,7 +71,7 @@ function QuestOverlayUI:UpdatePlayButton(soundTitle, questID, questLogTitleFrame
 			local cachedQuestData = Addon.QuestLog[soundTitle]
             if cachedQuestData ~= nil then
 				name = cachedQuestData.questGiverName
-                unitID = Utils:GetIDFromGUID(cachedQuestData.questgiverGUID)
+                unitID = Utils:GetIDFromServerGUID(cachedQuestData.questgiverGUID)
             end
 			
 			QuestOverlayUI.questPlayButtons[questID].soundData = 
@@ -141,7 +141,7 @@ function QuestOverlayUI:Update()
             local unitID = 0
             if Addon.QuestLog[title] ~= nil then
                 questID = Addon.QuestLog[title].id
-                unitID = Utils:GetIDFromGUID(Addon.QuestLog[title].questgiverGUID)
+                unitID = Utils:GetIDFromServerGUID(Addon.QuestLog[title].questgiverGUID)
             end
 
             if not self.questPlayButtons[questID] then
@@ -8,6 +8,7 @@ setfenv(1, VoiceOver)
 ---@field title? string Quest title or gossip option text that are the subject of the voiceover
 ---@field text? string Quest text or gossip text that are the subject of the voiceover
 ---@field questID? number Quest ID that is the subject of the voiceover
+---@field textHash? string Gossip text hash resolved by the server, skips the gossip text search when present
 ---@field delay? number Duration in seconds to wait before playing the sound file
 ---@field addedCallback? fun(soundData: SoundData) Function to call if the voiceover was successfully added to the queue
 ---@field startCallback? fun(soundData: SoundData) Function to call when the voiceover starts playing
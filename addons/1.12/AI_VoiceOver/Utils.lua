@@ -37,6 +37,16 @@ function Utils:GetIDFromGUID(guid)
     return assert(tonumber(values[6]), format([[Failed to retrieve ID from GUID "%s"]], guid))
 end
 
+--- Returns WorldObject ID of a quest giver GUID sent by the server.
+---
+--- The server always builds these as `Type-0-0-0-0-ID-0`, including Item quest starters which `Utils:GetIDFromGUID` rejects.
+---@param guid string GUID received from the server
+---@return number id
+function Utils:GetIDFromServerGUID(guid)
+    local values = Utils:Explode(guid, "-")
+    return tonumber(values[6]) or 0
+end
+
 --- Returns a dummy WorldObject GUID using the provided `Enums.GUID` type and ID.
 --- - Returns nil in clients before 2.3 as those don't provide `UnitGUID(unitID)` function.
 --- - Overridden for clients before 6.0 that use an older GUID format.
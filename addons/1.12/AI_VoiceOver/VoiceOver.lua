@@ -8,6 +8,11 @@ Addon.OnAddonLoad = {}
 
 Addon.QuestLog = {}
 
+-- Quests of the zones the server sent the hints of, by quest ID. The titles map to their quest ID,
+-- or to false when several quests share the title and it can't tell them apart.
+Addon.ZoneQuests = {}
+Addon.ZoneQuestIDsByTitle = {}
+
 ---@class VoiceOverConfig
 local defaults = {
     profile = {
@@ -47,26 +52,49 @@ local defaults = {
         IsPaused = false,
         hasSeenGossipForNPC = {},
         RecentQuestTitleToID = Version:IsBelowLegacyVersion(30300) and {},
+        QuestLog = {}, -- Kept between sessions so the server can skip the quest log sync when nothing changed
+        QuestLogSequence = 0, -- Sequence number of the last quest log change applied to QuestLog
     }
 }
 
 Addon.serverMessagePrefix = "voiceover"
 Addon.initialized = false
+Addon.capabilities = Enums.AddonCapability.QuestLogSnapshot + Enums.AddonCapability.CompactProtocol + Enums.AddonCapability.SoundEventPush + Enums.AddonCapability.QuestLogDeltas + Enums.AddonCapability.AddonChannel + Enums.AddonCapability.BatchedMessages + Enums.AddonCapability.CreatureTexts + Enums.AddonCapability.ZoneQuestHints + Enums.AddonCapability.QuestTextFingerprints
+Addon.serverCapabilities = 0
+Addon.questLogCatchUpPending = false
+
+-- Giver types of the protocol v2 messages
+local compactGiverTypes = { c = "Creature", o = "GameObject", i = "Item" }
 
 local lastGossipOptions
 local selectedGossipOption
 local currentQuestSoundData
 local currentGossipSoundData
+local expectedGossipEvent
 
-function Addon:SendServerMessage(msg)
+-- Longest chat message the client sends as is
+local MAX_CHAT_MESSAGE_LENGTH = 255
+
+function Addon:SendServerCommand(msg)
 	SendChatMessage("." .. self.serverMessagePrefix .. " " .. msg)
 end
 
+function Addon:SendServerMessage(msg)
+	if self:HasServerCapability(Enums.AddonCapability.AddonChannel) then
+		-- The server takes the whisper before it is delivered, so it never shows up in the chat
+		SendChatMessage(self.serverMessagePrefix .. "\t" .. msg, "WHISPER", nil, UnitName("player"))
+	else
+		self:SendServerCommand(msg)
+	end
+end
+
 function Addon:OnInitialize()
     self.db = LibStub("AceDB-3.0"):New("VoiceOverDB", defaults)
     self.db.RegisterCallback(self, "OnProfileChanged", "RefreshConfig")
     self.db.RegisterCallback(self, "OnProfileReset", "RefreshConfig")
 
+    Addon.QuestLog = self.db.char.QuestLog
+
     StaticPopupDialogs["VOICEOVER_ERROR"] =
     {
         text = "VoiceOver|n|n%s",
@@ -85,6 +113,8 @@ function Addon:OnInitialize()
 	self:RegisterEvent("QUEST_DETAIL")
 	self:RegisterEvent("QUEST_PROGRESS")
 	self:RegisterEvent("QUEST_COMPLETE")
+	self:RegisterEvent("QUEST_GREETING")
+	self:RegisterEvent("GOSSIP_SHOW")
 
     if select(5, GetAddOnInfo("VoiceOver")) ~= "MISSING" then
         DisableAddOn("VoiceOver")
@@ -198,16 +228,103 @@ function Addon:Explode(str, delimiter)
     return result
 end
 
+-- Protocol v2 writes the numbers in base 36
+function Addon:DecodeNumber(str)
+    return tonumber(str or "", 36) or 0
+end
+
+-- Turns a protocol v2 giver ("c" followed by the creature entry) back into the GUID the v1 messages carry
+function Addon:DecodeGiver(giver)
+    local typeName = giver and compactGiverTypes[string.sub(giver, 1, 1)]
+    if not typeName then
+        return ""
+    end
+    return format("%s-0-0-0-0-%d-0", typeName, self:DecodeNumber(string.sub(giver, 2)))
+end
+
+-- Capabilities the server granted in the handshake, no bit operations in Lua 5.0
+function Addon:HasServerCapability(capability)
+    return math.mod(math.floor(self.serverCapabilities / capability), 2) == 1
+end
+
+-- Same hash the server computes over the quest log: the sorted quest IDs and then their count folded as
+-- hash = (hash * 65599 + value) % 4294967291, which never goes above the 2^53 integers a number holds exactly
+function Addon:GetQuestLogHash()
+    local questIDs = {}
+    for _, questInfo in pairs(Addon.QuestLog) do
+        table.insert(questIDs, questInfo.id)
+    end
+    table.sort(questIDs)
+
+    local hash = 0
+    for _, questID in ipairs(questIDs) do
+        hash = math.mod(hash * 65599 + questID, 4294967291)
+    end
+    return math.mod(hash * 65599 + getn(questIDs), 4294967291)
+end
+
 function Addon:SendInitializeRequest()
-    Addon:SendServerMessage("enableAddon")
+    -- The handshake always goes as a chat command, a server that doesn't take the whispers anymore would deliver them
+    Addon:SendServerCommand(format("enableAddon %d %.0f %.0f", Addon.capabilities, Addon:GetQuestLogHash(), Addon.db.char.QuestLogSequence))
 end
 
 function Addon:SendQuestLogRequest()
     Addon:SendServerMessage("questLog")
 end
 
-function Addon:SendSoundEventRequest(eventType, id, eventTitle)
-    Addon:SendServerMessage("soundEvent "..eventType..";"..id..";"..eventTitle)
+-- Asks for the quest log changes after the last one applied, the server sends the whole quest log if it no longer has them
+function Addon:SendQuestLogCatchUpRequest()
+    if not self.questLogCatchUpPending then
+        self.questLogCatchUpPending = true
+        Addon:SendServerMessage(format("questLog %.0f", self.db.char.QuestLogSequence))
+    end
+end
+
+local fingerprintBitMasks = { 1, 2, 4, 8, 16, 32, 64, 128 }
+
+-- The words of the text as a set of 256 bits in 64 hex digits. It must hash the words exactly
+-- like the server does (VoiceoverTextFingerprint.cpp), with arithmetic only as there is no bit library.
+function Addon:GetTextFingerprint(text)
+    local bytes = {}
+    for i = 1, 32 do
+        bytes[i] = 0
+    end
+
+    for word in string.gfind(string.lower(text or ""), "[^%s%p]+") do
+        local hash = 0
+        for i = 1, string.len(word) do
+            hash = math.mod(hash * 31 + string.byte(word, i), 16777216)
+        end
+
+        local bit = math.floor(math.mod(hash * 10368889, 16777216) / 65536)
+        local index = math.floor(bit / 8) + 1
+        local mask = fingerprintBitMasks[math.mod(bit, 8) + 1]
+        if math.mod(math.floor(bytes[index] / mask), 2) == 0 then
+            bytes[index] = bytes[index] + mask
+        end
+    end
+
+    local hex = ""
+    for i = 1, 32 do
+        hex = hex .. format("%02x", bytes[i])
+    end
+    return hex
+end
+
+function Addon:SendSoundEventRequest(eventType, id, eventTitle, questText)
+    -- Quests are found by title when their id is unknown, the fingerprint of the frame text picks the
+    -- right one when the npc has several quests with that title. The field is there even when empty.
+    if Enums.SoundEvent:IsQuestEvent(eventType) and self:HasServerCapability(Enums.AddonCapability.QuestTextFingerprints) then
+        eventTitle = (id == 0 and questText and self:GetTextFingerprint(questText) or "") .. ";" .. eventTitle
+    end
+
+    -- Gossip texts can span several lines and be longer than a chat message, send the first words on a single line
+    local msg = "soundEvent "..eventType..";"..id..";"..string.gsub(eventTitle, "[%s|]+", " ")
+    local maxLength = MAX_CHAT_MESSAGE_LENGTH - string.len(self.serverMessagePrefix) - 2
+    if string.len(msg) > maxLength then
+        msg = string.gsub(string.sub(msg, 1, maxLength + 1), "%s+%S*$", "")
+    end
+    Addon:SendServerMessage(msg)
 end
 
 local function GossipSoundDataAdded(soundData)
@@ -217,6 +334,10 @@ local function GossipSoundDataAdded(soundData)
     currentGossipSoundData = soundData
 end
 
+local function CreatureTextSoundDataAdded(soundData)
+    Utils:CreateNPCModelFrame(soundData)
+end
+
 local function QuestSoundDataAdded(soundData)
     Utils:CreateNPCModelFrame(soundData)
 
@@ -224,16 +345,19 @@ local function QuestSoundDataAdded(soundData)
     currentQuestSoundData = soundData
 end
 
-function Addon:HandleInitialize()
+function Addon:HandleInitialize(inSync)
     if Addon.initialized == false then
-        Addon:SendQuestLogRequest()
+        -- The quest log saved from the last session is still valid when the server says so
+        if not inSync then
+            Addon:SendQuestLogRequest()
+        end
         Addon.initialized = true
     end
 end
 
 -- Store original function before EQL3 (Extended Quest Log 3) overrides it and starts prepending quest level
 local GetTitleText = GetTitleText 
-function Addon:HandleSoundEvent(eventType, id, guid, eventTitle, targetName)
+function Addon:HandleSoundEvent(eventType, id, guid, eventTitle, targetName, textHash)
     if Enums.SoundEvent:IsQuestEvent(eventType) then
         if eventTitle == "" then
             eventTitle = GetTitleText()
@@ -244,7 +368,7 @@ function Addon:HandleSoundEvent(eventType, id, guid, eventTitle, targetName)
         end
 
         local guidType = Utils:GetGUIDType(guid)
-        local unitID = Utils:GetIDFromGUID(guid)
+        local unitID = Utils:GetIDFromServerGUID(guid)
 
         local soundData = 
 	    {
@@ -258,10 +382,97 @@ function Addon:HandleSoundEvent(eventType, id, guid, eventTitle, targetName)
 		    addedCallback = QuestSoundDataAdded
 	    }
 		
+        SoundQueue:AddSoundToQueue(soundData)
+    elseif eventType == Enums.SoundEvent.CreatureText then
+        -- The server only sends the lines it found the sound of, the creature doesn't have to be targeted
+        if textHash == "" then
+            return
+        end
+
+        local soundData =
+        {
+            event = eventType,
+            name = targetName,
+            unitGUID = guid,
+            unitIsObjectOrItem = false,
+            textHash = textHash,
+            addedCallback = CreatureTextSoundDataAdded
+        }
+
+        SoundQueue:AddSoundToQueue(soundData)
+    elseif Enums.SoundEvent:IsGossipEvent(eventType) then
+        -- Pushed gossip events only play if the frame passed the gossip frequency check
+        if self:HasServerCapability(Enums.AddonCapability.SoundEventPush) then
+            if expectedGossipEvent ~= eventType then
+                return
+            end
+            expectedGossipEvent = nil
+        end
+
+        if guid == "" then
+            guid = nil
+        end
+
+        if targetName == "" then
+            targetName = Utils:GetNPCName()
+        end
+
+        local guidType = Utils:GetGUIDType(guid)
+
+        local soundData =
+        {
+            event = eventType,
+            name = targetName,
+            text = eventType == Enums.SoundEvent.QuestGreeting and GetGreetingText() or GetGossipText(),
+            unitGUID = guid,
+            unitIsObjectOrItem = guidType == Enums.GUID.Item or guidType == Enums.GUID.GameObject or (not guid and Utils:IsNPCObjectOrItem()),
+            textHash = textHash ~= "" and textHash or nil,
+            addedCallback = GossipSoundDataAdded
+        }
+
         SoundQueue:AddSoundToQueue(soundData)
     end
 end
 
+function Addon:HandleZoneQuestHints(records)
+    for _, record in ipairs(self:Explode(records, "^")) do
+        -- questID;starter;ender;questTitle
+        local args = self:Explode(record, ";")
+        local questID = self:DecodeNumber(args[1])
+        local questTitle = table.concat(args, ";", 4)
+        Addon.ZoneQuests[questID] =
+        {
+            starter = self:DecodeGiver(args[2]),
+            ender = self:DecodeGiver(args[3]),
+            title = questTitle
+        }
+
+        local knownID = Addon.ZoneQuestIDsByTitle[questTitle]
+        if knownID == nil or knownID == questID then
+            Addon.ZoneQuestIDsByTitle[questTitle] = questID
+        else
+            Addon.ZoneQuestIDsByTitle[questTitle] = false
+        end
+    end
+end
+
+-- Quest ID of the title in the zone quest hints, nil if the hints don't have it or several quests share it
+function Addon:GetZoneQuestID(questTitle)
+    return questTitle and Addon.ZoneQuestIDsByTitle[questTitle] or nil
+end
+
+-- Plays the quest sound event of the dialog without asking the server, false if the zone quest hints don't know the quest
+function Addon:PlayZoneQuestSoundEvent(eventType, questTitle)
+    local questID = self:GetZoneQuestID(questTitle)
+    if not questID then
+        return false
+    end
+
+    local quest = Addon.ZoneQuests[questID]
+    self:HandleSoundEvent(eventType, questID, eventType == Enums.SoundEvent.QuestAccept and quest.starter or quest.ender, questTitle, "")
+    return true
+end
+
 function Addon:HandleQuestLog(status, questID, guid, questTitle, questGiverName)
     if status == 1 then
         Addon.QuestLog[questTitle] =
@@ -276,30 +487,152 @@ function Addon:HandleQuestLog(status, questID, guid, questTitle, questGiverName)
     end
 end
 
+function Addon:RemoveQuestLogEntry(questID)
+    for questTitle, questInfo in pairs(Addon.QuestLog) do
+        if questInfo.id == questID then
+            Addon.QuestLog[questTitle] = nil
+            return
+        end
+    end
+end
+
+-- Quest log changes are applied in order, a gap means some were missed
+function Addon:AcceptQuestLogDelta(sequence)
+    local lastSequence = self.db.char.QuestLogSequence
+    if not sequence or sequence <= lastSequence then
+        return false
+    elseif sequence > lastSequence + 1 then
+        self:SendQuestLogCatchUpRequest()
+        return false
+    end
+
+    self.db.char.QuestLogSequence = sequence
+    self.questLogCatchUpPending = false
+    return true
+end
+
+function Addon:HandleQuestLogSnapshot(part, parts, records, compact, sequence)
+    -- A full snapshot replaces whatever was known about the quest log
+    if part == 1 then
+        for questTitle in pairs(Addon.QuestLog) do
+            Addon.QuestLog[questTitle] = nil
+        end
+
+        -- The changes that follow are numbered from the snapshot on
+        if sequence then
+            self.db.char.QuestLogSequence = sequence
+            self.questLogCatchUpPending = false
+        end
+    end
+
+    if records ~= "" then
+        for _, record in ipairs(self:Explode(records, "^")) do
+            -- questID;guid;questTitle;questGiverName
+            local args = self:Explode(record, ";")
+            if compact then
+                self:HandleQuestLog(1, self:DecodeNumber(args[1]), self:DecodeGiver(args[2]), args[3], args[4])
+            else
+                self:HandleQuestLog(1, tonumber(args[1]), args[2], args[3], args[4])
+            end
+        end
+    end
+end
+
 function Addon:HandleServerMessage(msg)
 	local args = self:Explode(msg, "#")
-	if string.find(msg, "AddonEnabled", 1, true) then
-		self:HandleInitialize()
-	elseif string.find(msg, "SoundEvent", 1, true) then
-		-- SoundEvent#Enums.SoundEvent;id;guid;eventTitle;targetName
+	local command = args[1]
+	if command == "AddonEnabled" then
+		-- AddonEnabled[#capabilities[;inSync[;questLogSequence]]]
+		local status = self:Explode(args[2] or "", ";")
+		self.serverCapabilities = tonumber(status[1]) or 0
+		if status[3] then
+			-- A later handshake that doesn't continue from the last change applied starts over from the server's quest log
+			local sequence = tonumber(status[3]) or 0
+			if self.initialized and status[2] ~= "1" and sequence ~= self.db.char.QuestLogSequence then
+				self:SendQuestLogRequest()
+			end
+			self.db.char.QuestLogSequence = sequence
+			self.questLogCatchUpPending = false
+		end
+		self:HandleInitialize(status[2] == "1")
+	elseif command == "SoundEvent" then
+		-- SoundEvent#Enums.SoundEvent;id;guid;eventTitle;targetName[;textHash]
 		args = self:Explode(args[2], ";")
-		self:HandleSoundEvent(tonumber(args[1]), tonumber(args[2]), args[3], args[4], args[5])
-    elseif string.find(msg, "QuestLog", 1, true) then
+		self:HandleSoundEvent(tonumber(args[1]), tonumber(args[2]), args[3], args[4], args[5], args[6])
+    elseif command == "QuestLog" then
         -- QuestLog#status;questID;guid;questTitle;questGiverName
 		args = self:Explode(args[2], ";")
         self:HandleQuestLog(tonumber(args[1]), tonumber(args[2]), args[3], args[4], args[5])
+    elseif command == "QuestDelta" then
+        -- QuestDelta#sequence;status;questID;guid;questTitle;questGiverName
+        args = self:Explode(args[2], ";")
+        if self:AcceptQuestLogDelta(tonumber(args[1])) then
+            self:HandleQuestLog(tonumber(args[2]), tonumber(args[3]), args[4], args[5], args[6])
+        end
+    elseif command == "QuestSnapshot" then
+        -- QuestSnapshot#part;parts[;questLogSequence]#questID;guid;questTitle;questGiverName^...
+        local header = self:Explode(args[2], ";")
+        self:HandleQuestLogSnapshot(tonumber(header[1]), tonumber(header[2]), table.concat(args, "#", 3), false, tonumber(header[3] or ""))
+    elseif command == "S" then
+        -- S#Enums.SoundEvent;id[;giver[;targetName[;textHash]]]
+        -- The title always comes from the open frame, the name too unless the giver is an item or the event a creature text
+        args = self:Explode(args[2], ";")
+        self:HandleSoundEvent(tonumber(args[1]), self:DecodeNumber(args[2]), self:DecodeGiver(args[3]), "", args[4] or "", args[5] or "")
+    elseif command == "L" then
+        -- L#1;questID;giver;questTitle;questGiverName or L#0;questID
+        args = self:Explode(args[2], ";")
+        if tonumber(args[1]) == 1 then
+            self:HandleQuestLog(1, self:DecodeNumber(args[2]), self:DecodeGiver(args[3]), args[4], args[5])
+        else
+            self:RemoveQuestLogEntry(self:DecodeNumber(args[2]))
+        end
+    elseif command == "D" then
+        -- D#sequence;1;questID;giver;questTitle;questGiverName or D#sequence;0;questID
+        args = self:Explode(args[2], ";")
+        if self:AcceptQuestLogDelta(self:DecodeNumber(args[1])) then
+            if tonumber(args[2]) == 1 then
+                self:HandleQuestLog(1, self:DecodeNumber(args[3]), self:DecodeGiver(args[4]), args[5], args[6])
+            else
+                self:RemoveQuestLogEntry(self:DecodeNumber(args[3]))
+            end
+        end
+    elseif command == "Q" then
+        -- Q#part;parts[;questLogSequence]#questID;giver;questTitle;questGiverName^...
+        local header = self:Explode(args[2], ";")
+        self:HandleQuestLogSnapshot(tonumber(header[1]), tonumber(header[2]), table.concat(args, "#", 3), true, tonumber(header[3] or ""))
+    elseif command == "Z" then
+        -- Z#zoneID;part;parts#questID;starter;ender;questTitle^...
+        -- Every part stands on its own, they only add to the quests already known
+        self:HandleZoneQuestHints(table.concat(args, "#", 3))
 	end
 end
 
 function Addon:QUEST_DETAIL()
-	local questID = GetQuestID()
+	-- The server sends the quest sound events along with the frame when it can
+	if self:HasServerCapability(Enums.AddonCapability.SoundEventPush) then
+		return
+	end
+
 	local questTitle = GetTitleText()
-	Addon:SendSoundEventRequest(Enums.SoundEvent.QuestAccept, questID, questTitle)
+	if self:PlayZoneQuestSoundEvent(Enums.SoundEvent.QuestAccept, questTitle) then
+		return
+	end
+
+	local questID = GetQuestID()
+	Addon:SendSoundEventRequest(Enums.SoundEvent.QuestAccept, questID, questTitle, GetQuestText())
 end
 
 function Addon:QUEST_PROGRESS()
+	if self:HasServerCapability(Enums.AddonCapability.SoundEventPush) then
+		return
+	end
+
 	local questID = 0
 	local questTitle = GetTitleText()
+	if self:PlayZoneQuestSoundEvent(Enums.SoundEvent.QuestProgress, questTitle) then
+		return
+	end
+
 	if questID == 0 then
 		local questTitle = GetTitleText()
 		local questInfo = Addon.QuestLog[questTitle];
@@ -308,12 +641,20 @@ function Addon:QUEST_PROGRESS()
 		end
 	end
 	
-	Addon:SendSoundEventRequest(Enums.SoundEvent.QuestProgress, questID, questTitle)
+	Addon:SendSoundEventRequest(Enums.SoundEvent.QuestProgress, questID, questTitle, GetProgressText())
 end
 
 function Addon:QUEST_COMPLETE()
-	local questID = GetQuestID()
+	if self:HasServerCapability(Enums.AddonCapability.SoundEventPush) then
+		return
+	end
+
 	local questTitle = GetTitleText()
+	if self:PlayZoneQuestSoundEvent(Enums.SoundEvent.QuestComplete, questTitle) then
+		return
+	end
+
+	local questID = GetQuestID()
 	if questID == 0 then
 		local questTitle = GetTitleText()
 		local questInfo = Addon.QuestLog[questTitle];
@@ -322,12 +663,44 @@ function Addon:QUEST_COMPLETE()
 		end
 	end
 	
-	Addon:SendSoundEventRequest(Enums.SoundEvent.QuestComplete, questID, questTitle)
+	Addon:SendSoundEventRequest(Enums.SoundEvent.QuestComplete, questID, questTitle, GetRewardText())
+end
+
+function Addon:RequestGossipSoundEvent(eventType, text)
+	-- A pushed sound event arrives right after the frame, it only has to be let through
+	if self:HasServerCapability(Enums.AddonCapability.SoundEventPush) then
+		expectedGossipEvent = eventType
+	else
+		Addon:SendSoundEventRequest(eventType, 0, text)
+	end
+end
+
+function Addon:QUEST_GREETING()
+	expectedGossipEvent = nil
+	local text = GetGreetingText()
+	local play, npcKey = self:ShouldPlayGossip(Utils:GetNPCGUID(), text)
+	if play then
+		self.db.char.hasSeenGossipForNPC[npcKey] = true
+		Addon:RequestGossipSoundEvent(Enums.SoundEvent.QuestGreeting, text)
+	end
+end
+
+function Addon:GOSSIP_SHOW()
+	expectedGossipEvent = nil
+	local text = GetGossipText()
+	local play, npcKey = self:ShouldPlayGossip(Utils:GetNPCGUID(), text)
+	if play then
+		self.db.char.hasSeenGossipForNPC[npcKey] = true
+		Addon:RequestGossipSoundEvent(Enums.SoundEvent.Gossip, text)
+	end
 end
 
 function Addon:CHAT_MSG_ADDON()
 	if string.find(arg1, self.serverMessagePrefix, 1, true) then
-        Addon:HandleServerMessage(arg2)
+		-- The server sends the messages of the same update together
+		for _, msg in ipairs(self:Explode(arg2, "\30")) do
+			Addon:HandleServerMessage(msg)
+		end
 	end
 end
 
@@ -346,7 +719,7 @@ function Addon:ADDON_LOADED(event, addon)
 end
 
 function Addon:ShouldPlayGossip(guid, text)
-    local npcKey = guid or "unknown"
+    local npcKey = guid or Utils:GetNPCName() or "unknown"
 
     local gossipSeenForNPC = self.db.char.hasSeenGossipForNPC[npcKey]
 
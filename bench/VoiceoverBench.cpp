@@ -0,0 +1,986 @@
+// Standalone benchmark of the voiceover module handlers.
+//
+// Builds a synthetic world (quests with their locales, creature and gameobject givers,
+// players with full quest logs) in the stubbed object manager and drives the module
+// through the same entry points the core uses, reporting throughput, heap allocations
+// and the addon messages sent per operation.
+
+#include "VoiceoverModule.h"
+
+#include "Globals/ObjectAccessor.h"
+#include "Globals/ObjectMgr.h"
+#include "Server/SQLStorages.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <thread>
+
+namespace
+{
+    // Every heap allocation made while a benchmark runs is counted
+    std::atomic<uint64> allocationCount(0);
+    std::atomic<uint64> allocationBytes(0);
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+// The standard library asks for some temporary buffers (e.g. std::stable_sort) without exceptions
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+using namespace cmangos_module;
+
+namespace
+{
+    constexpr uint32 BENCH_LOCALES = 8;
+    constexpr uint32 FIRST_QUEST_ID = 1;
+    constexpr uint32 FIRST_CREATURE_ENTRY = 1;
+    constexpr uint32 FIRST_GAMEOBJECT_ENTRY = 1;
+    // The quests are spread over this many zones, a few dozen quests each like the starting zones
+    constexpr uint32 BENCH_ZONES = 50;
+
+    struct BenchOptions
+    {
+        uint32 quests = 10000;
+        uint32 creatures = 20000;
+        uint32 gameObjects = 2000;
+        uint32 players = 5000;
+        uint32 iterations = 200000;
+    };
+
+    struct BenchPlayer
+    {
+        std::unique_ptr<WorldSession> session;
+        std::unique_ptr<Player> player;
+    };
+
+    struct QuestGivers
+    {
+        ObjectGuid starter;
+        ObjectGuid ender;
+    };
+
+    const char* const words[] =
+    {
+        "the", "of", "lost", "hunt", "shadow", "blood", "wolves", "tome", "crown", "ancient", "stone", "fire",
+        "river", "keeper", "return", "to", "darkshire", "goldshire", "missing", "supplies", "report", "warden",
+        "cursed", "relic", "spider", "silk", "murloc", "raid", "elder", "spirit", "forsaken", "gnoll",
+        "bounty", "letter", "for", "captain", "iron", "forge", "mine", "kobold", "candles", "troll",
+        "ruins", "secrets", "orders", "plague", "scourge", "dragon", "scale", "grove", "moon", "well"
+    };
+
+    std::string MakeText(std::mt19937& rng, uint32 minWords, uint32 maxWords)
+    {
+        std::uniform_int_distribution<uint32> wordCount(minWords, maxWords);
+        std::uniform_int_distribution<uint32> wordIndex(0, (uint32)(sizeof(words) / sizeof(words[0])) - 1);
+
+        std::string text;
+        const uint32 count = wordCount(rng);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            if (i > 0)
+            {
+                text.push_back(' ');
+            }
+
+            text.append(words[wordIndex(rng)]);
+        }
+
+        if (!text.empty())
+        {
+            text[0] = (char)toupper(text[0]);
+        }
+
+        return text;
+    }
+
+    // Owns the names the creature and gameobject templates point to
+    std::vector<std::unique_ptr<char[]>> templateNames;
+
+    char* AddTemplateName(const std::string& name)
+    {
+        templateNames.emplace_back(mangos_strdup(name.c_str()));
+        return templateNames.back().get();
+    }
+
+    std::string MakeLocaleText(const std::string& text, uint32 locale)
+    {
+        return text + " [" + std::to_string(locale + 1) + "]";
+    }
+
+    void GenerateWorld(const BenchOptions& options, std::vector<QuestGivers>& questGivers)
+    {
+        std::mt19937 rng(12345);
+
+        for (uint32 i = 0; i < options.creatures; ++i)
+        {
+            const uint32 entry = FIRST_CREATURE_ENTRY + i;
+            const std::string name = MakeText(rng, 1, 3);
+            sCreatureStorage.Add(CreatureInfo{ entry, AddTemplateName(name) }, entry);
+
+            CreatureLocale& creatureLocale = sObjectMgr.mCreatureLocaleMap[entry];
+            for (uint32 locale = 0; locale < BENCH_LOCALES; ++locale)
+            {
+                creatureLocale.Name.push_back(MakeLocaleText(name, locale));
+            }
+        }
+
+        for (uint32 i = 0; i < options.gameObjects; ++i)
+        {
+            const uint32 entry = FIRST_GAMEOBJECT_ENTRY + i;
+            const std::string name = MakeText(rng, 1, 3);
+            sGOStorage.Add(GameObjectInfo{ entry, AddTemplateName(name) }, entry);
+
+            GameObjectLocale& gameObjectLocale = sObjectMgr.mGameObjectLocaleMap[entry];
+            for (uint32 locale = 0; locale < BENCH_LOCALES; ++locale)
+            {
+                gameObjectLocale.Name.push_back(MakeLocaleText(name, locale));
+            }
+        }
+
+        // One in ten quests is started or ended on a gameobject, like in the real world data
+        std::uniform_int_distribution<uint32> creatureEntry(FIRST_CREATURE_ENTRY, FIRST_CREATURE_ENTRY + options.creatures - 1);
+        std::uniform_int_distribution<uint32> gameObjectEntry(FIRST_GAMEOBJECT_ENTRY, FIRST_GAMEOBJECT_ENTRY + std::max(options.gameObjects, 1u) - 1);
+        std::uniform_int_distribution<uint32> percent(0, 99);
+
+        // One in twenty quests is a repeatable version of the one before, with the same title and givers
+        // but other texts, so the title lookups have to tell them apart
+        questGivers.resize(options.quests);
+        for (uint32 i = 0; i < options.quests; ++i)
+        {
+            const bool isRepeatable = i > 0 && i % 20 == 0;
+            auto quest = std::make_unique<Quest>();
+            quest->QuestId = FIRST_QUEST_ID + i;
+            quest->Title = isRepeatable ? sObjectMgr.GetQuestTemplate(quest->QuestId - 1)->GetTitle() : MakeText(rng, 2, 5);
+            quest->ZoneOrSort = 1 + i % BENCH_ZONES;
+            quest->Details = MakeText(rng, 40, 120);
+            quest->Objectives = MakeText(rng, 10, 30);
+            quest->RequestItemsText = MakeText(rng, 10, 40);
+            quest->OfferRewardText = MakeText(rng, 20, 60);
+
+            QuestLocale& questLocale = sObjectMgr.mQuestLocaleMap[quest->QuestId];
+            for (uint32 locale = 0; locale < BENCH_LOCALES; ++locale)
+            {
+                questLocale.Title.push_back(MakeLocaleText(quest->Title, locale));
+            }
+
+            QuestGivers& givers = questGivers[i];
+            for (uint32 relation = 0; relation < 2; ++relation)
+            {
+                const ObjectGuid& previousGiver = isRepeatable ? (relation == 0 ? questGivers[i - 1].starter : questGivers[i - 1].ender) : ObjectGuid();
+                const bool isGameObject = isRepeatable ? previousGiver.IsGameObject() : options.gameObjects > 0 && percent(rng) < 10;
+                const uint32 entry = isRepeatable ? previousGiver.GetEntry() : isGameObject ? gameObjectEntry(rng) : creatureEntry(rng);
+                if (isGameObject)
+                {
+                    (relation == 0 ? sObjectMgr.m_GOQuestRelations : sObjectMgr.m_GOQuestInvolvedRelations).insert({ entry, quest->QuestId });
+                    (relation == 0 ? givers.starter : givers.ender) = ObjectGuid(HighGuid::HIGHGUID_GAMEOBJECT, entry, i + 1);
+                }
+                else
+                {
+                    (relation == 0 ? sObjectMgr.m_CreatureQuestRelations : sObjectMgr.m_CreatureQuestInvolvedRelations).insert({ entry, quest->QuestId });
+                    (relation == 0 ? givers.starter : givers.ender) = ObjectGuid(HighGuid::HIGHGUID_UNIT, entry, i + 1);
+                }
+            }
+
+            sObjectMgr.mQuestTemplates[quest->QuestId] = std::move(quest);
+        }
+    }
+
+    void GeneratePlayers(const BenchOptions& options, std::vector<BenchPlayer>& players)
+    {
+        std::mt19937 rng(54321);
+        std::uniform_int_distribution<int> localeIndex(-1, BENCH_LOCALES - 1);
+        std::uniform_int_distribution<uint32> questId(FIRST_QUEST_ID, FIRST_QUEST_ID + options.quests - 1);
+
+        players.resize(options.players);
+        for (uint32 i = 0; i < options.players; ++i)
+        {
+            BenchPlayer& benchPlayer = players[i];
+            benchPlayer.session = std::make_unique<WorldSession>(i + 1, localeIndex(rng));
+            benchPlayer.player = std::make_unique<Player>(benchPlayer.session.get());
+            benchPlayer.player->m_guid = ObjectGuid(HighGuid::HIGHGUID_PLAYER, i + 1);
+            benchPlayer.session->SetPlayer(benchPlayer.player.get());
+
+            for (uint16 slot = 0; slot < MAX_QUEST_LOG_SIZE; ++slot)
+            {
+                benchPlayer.player->SetQuestSlot(slot, questId(rng));
+            }
+
+            sObjectAccessor.players[benchPlayer.player->GetObjectGuid().GetRawValue()] = benchPlayer.player.get();
+        }
+    }
+
+    // 64 hex digits as the addon sends them
+    std::string FormatTextFingerprint(const TextFingerprint& fingerprint)
+    {
+        std::string hex;
+        for (uint32 byte = 0; byte < TEXT_FINGERPRINT_BITS / 8; ++byte)
+        {
+            char digits[3];
+            snprintf(digits, sizeof(digits), "%02x", (uint32)(fingerprint.words[byte / 8] >> (byte % 8 * 8)) & 0xFF);
+            hex += digits;
+        }
+
+        return hex;
+    }
+
+    uint64 GetSentPackets(const std::vector<BenchPlayer>& players, uint64* bytes)
+    {
+        uint64 packets = 0;
+        *bytes = 0;
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            packets += benchPlayer.session->GetSentPackets();
+            *bytes += benchPlayer.session->GetSentBytes();
+        }
+
+        return packets;
+    }
+
+    // A world update followed by the updates of the players, which send the addon messages they got
+    void UpdateWorld(VoiceoverModule& module, const std::vector<BenchPlayer>& players)
+    {
+        module.OnUpdate(0);
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+    }
+
+    // Runs the operation the given number of times and prints one line of results
+    template<class Operation>
+    void Run(const char* name, uint32 iterations, const std::vector<BenchPlayer>& players, Operation operation)
+    {
+        uint64 bytesBefore = 0;
+        const uint64 packetsBefore = GetSentPackets(players, &bytesBefore);
+        const uint64 allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        const uint64 allocatedBefore = allocationBytes.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32 i = 0; i < iterations; ++i)
+        {
+            operation(i);
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        const uint64 allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        const uint64 allocated = allocationBytes.load(std::memory_order_relaxed) - allocatedBefore;
+        uint64 bytesAfter = 0;
+        const uint64 packets = GetSentPackets(players, &bytesAfter) - packetsBefore;
+        const uint64 bytes = bytesAfter - bytesBefore;
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        const double ops = iterations > 0 ? (double)iterations : 1.0;
+        printf("%-34s %10u %12.0f %10.1f %10.2f %10.0f %8.2f %10.1f\n", name, iterations,
+            seconds > 0.0 ? iterations / seconds : 0.0, seconds * 1e9 / ops,
+            allocations / ops, allocated / ops, packets / ops, bytes / ops);
+    }
+
+    void PrintHeader()
+    {
+        printf("%-34s %10s %12s %10s %10s %10s %8s %10s\n", "benchmark", "ops", "ops/s", "ns/op", "allocs/op", "bytes/op", "pkts/op", "sent/op");
+    }
+
+    void SetConfig(VoiceoverModule& module, const char* name, const std::string& value)
+    {
+        ModuleConfig* config = const_cast<VoiceoverModuleConfig*>(module.GetConfig());
+        config->config.Set(name, value);
+    }
+
+    void LoadConfig(VoiceoverModule& module, uint32 resolverThreads)
+    {
+        // No rate limit or dedupe window, the benchmarks repeat requests on purpose
+        SetConfig(module, "Voiceover.Enable", "1");
+        SetConfig(module, "Voiceover.RateLimit.Burst", "0");
+        SetConfig(module, "Voiceover.DedupeWindow", "0");
+        SetConfig(module, "Voiceover.StatsLogInterval", "0");
+        SetConfig(module, "Voiceover.ResolverThreads", std::to_string(resolverThreads));
+
+        // The features that depend on the optional core hooks are measured as well
+        SetConfig(module, "Voiceover.PushSoundEvents", "1");
+        SetConfig(module, "Voiceover.AddonChannel", "1");
+        SetConfig(module, "Voiceover.CreatureTexts", "1");
+        module.LoadConfig();
+    }
+
+    // Every handler is followed by an update of its player, which sends the replies. The addon messages use
+    // the given protocol, v2 addons also take several messages batched into a single addon message.
+    void RunHandlerBenchmarks(const BenchOptions& options, const std::vector<QuestGivers>& questGivers, const std::vector<BenchPlayer>& players, AddonProtocol protocol)
+    {
+        const uint32 iterations = options.iterations;
+        const uint32 playerCount = options.players;
+
+        uint32 capabilities = (uint32)AddonCapability::QUEST_LOG_SNAPSHOT | (uint32)AddonCapability::SOUND_EVENT_PUSH;
+        if (protocol == AddonProtocol::V2)
+        {
+            capabilities |= (uint32)AddonCapability::COMPACT_PROTOCOL | (uint32)AddonCapability::BATCHED_MESSAGES;
+        }
+
+        const std::string enabledCapabilities = std::to_string(capabilities);
+
+        VoiceoverModule module;
+        LoadConfig(module, 0);
+
+        printf("Protocol v%u\n", (uint32)protocol);
+        PrintHeader();
+        Run("OnInitialize (index build)", 1, players, [&](uint32)
+        {
+            module.OnInitialize();
+        });
+
+        // Pushing and the addon channel are only offered once the core called their hooks, as a patched core does
+        // for any player
+        module.OnSendQuestDetails(players[0].player.get(), FIRST_QUEST_ID, questGivers[0].starter);
+        module.OnHandleChatMessage(players[0].player.get(), CHAT_MSG_SAY, std::string());
+
+        Run("OnPreLoadFromDB + enableAddon", playerCount, players, [&](uint32 i)
+        {
+            module.OnPreLoadFromDB(players[i].player.get());
+            module.HandleEnableAddon(players[i].session.get(), enabledCapabilities);
+            module.OnUpdate(players[i].player.get(), 0);
+        });
+
+        // Accepting a quest is GetQuestPayload followed by SendAddonMessage. Every quest goes through
+        // the payload builder once in the first pass, the second pass only hits the payload cache
+        // so it measures the message being sent.
+        const uint32 payloadPasses = options.quests;
+        Run("OnAcceptQuest (payload build)", payloadPasses, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            module.OnAcceptQuest(benchPlayer.player.get(), FIRST_QUEST_ID + i, &questGivers[i].starter);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        // The addon was already told about those quests, a new handshake starts over from the players' quest logs
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.HandleEnableAddon(benchPlayer.session.get(), enabledCapabilities);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+
+        Run("OnAcceptQuest (payload cached)", payloadPasses, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            module.OnAcceptQuest(benchPlayer.player.get(), FIRST_QUEST_ID + i, &questGivers[i].starter);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        std::vector<std::string> soundEventById;
+        std::vector<std::string> soundEventByTitle;
+        std::vector<std::string> soundEventWhispers;
+        soundEventById.reserve(options.quests);
+        soundEventWhispers.reserve(options.quests);
+        soundEventByTitle.reserve(options.quests);
+        for (uint32 i = 0; i < options.quests; ++i)
+        {
+            const Quest* quest = sObjectMgr.GetQuestTemplate(FIRST_QUEST_ID + i);
+            soundEventById.push_back(std::to_string((uint32)SoundEvent::QUEST_ACCEPT) + ";" + std::to_string(quest->GetQuestId()) + ";" + quest->GetTitle());
+            soundEventByTitle.push_back(std::to_string((uint32)SoundEvent::QUEST_COMPLETE) + ";0;" + quest->GetTitle());
+            soundEventWhispers.push_back(std::string(module.GetChatCommandPrefix()) + "\tsoundEvent " + soundEventById.back());
+        }
+
+        Run("HandleSoundEventRequest (id)", iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            module.HandleSoundEventRequest(benchPlayer.session.get(), soundEventById[i % options.quests]);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        // The same requests as whispered over the addon channel, which skips the chat command lookup
+        Run("OnHandleChatMessage (id)", iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            module.OnHandleChatMessage(benchPlayer.player.get(), CHAT_MSG_WHISPER, soundEventWhispers[i % options.quests]);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        Run("HandleSoundEventRequest (title)", iterations, players, [&](uint32 i)
+        {
+            // Only the enUS title is sent, players with other locales resolve through the fallback
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            const uint32 questIndex = i % options.quests;
+            benchPlayer.player->SetSelectionGuid(questGivers[questIndex].ender);
+            module.HandleSoundEventRequest(benchPlayer.session.get(), soundEventByTitle[questIndex]);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        // The sound event pushed with the quest frame, no request to parse and the quest id is known
+        Run("OnSendQuestDetails (push)", iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            const uint32 questIndex = i % options.quests;
+            module.OnSendQuestDetails(benchPlayer.player.get(), FIRST_QUEST_ID + questIndex, questGivers[questIndex].starter);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        // The quest frame, accepting the quest and dropping it again all reach the player in the same update
+        Run("Quest details + accept + abandon", iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            const uint32 questIndex = i % options.quests;
+            module.OnSendQuestDetails(benchPlayer.player.get(), FIRST_QUEST_ID + questIndex, questGivers[questIndex].starter);
+            module.OnAcceptQuest(benchPlayer.player.get(), FIRST_QUEST_ID + questIndex, &questGivers[questIndex].starter);
+            module.OnAbandonQuest(benchPlayer.player.get(), FIRST_QUEST_ID + questIndex);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        // The payloads of the quest logs are built before, both quest log rows only measure the messages
+        const uint32 questLogIterations = std::max(iterations / 20, 1u);
+        for (uint32 i = 0; i < questLogIterations; ++i)
+        {
+            module.HandleQuestLogRequest(players[i % playerCount].session.get(), "");
+            module.OnUpdate(players[i % playerCount].player.get(), 0);
+        }
+
+        Run("HandleQuestLogRequest (snapshot)", questLogIterations, players, [&](uint32 i)
+        {
+            module.HandleQuestLogRequest(players[i % playerCount].session.get(), "");
+            module.OnUpdate(players[i % playerCount].player.get(), 0);
+        });
+
+        const std::string disableSnapshot = std::to_string(capabilities & ~(uint32)AddonCapability::QUEST_LOG_SNAPSHOT);
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.HandleEnableAddon(benchPlayer.session.get(), disableSnapshot);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+
+        Run("HandleQuestLogRequest (per quest)", questLogIterations, players, [&](uint32 i)
+        {
+            module.HandleQuestLogRequest(players[i % playerCount].session.get(), "");
+            module.OnUpdate(players[i % playerCount].player.get(), 0);
+        });
+
+        printf("SendAddonMessage packet growths: %llu\n", (unsigned long long)module.GetAddonMessageAllocations());
+        printf("\n");
+
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnLogOut(benchPlayer.player.get());
+        }
+    }
+
+    // Same requests with a voice manifest that only covers every other quest
+    void RunManifestBenchmarks(const BenchOptions& options, const std::vector<BenchPlayer>& players)
+    {
+        const uint32 iterations = options.iterations;
+        const uint32 playerCount = options.players;
+
+        const std::string manifestFile = (std::filesystem::temp_directory_path() / "voiceover_bench_manifest.tsv").string();
+        {
+            std::ofstream file(manifestFile);
+            for (uint32 i = 0; i < options.quests; i += 2)
+            {
+                file << "accept\t" << FIRST_QUEST_ID + i << "\t5.0\n";
+                file << "complete\t" << FIRST_QUEST_ID + i << "\t5.0\n";
+            }
+        }
+
+        VoiceoverModule module;
+        SetConfig(module, "Voiceover.VoiceManifestFile", manifestFile);
+        LoadConfig(module, 0);
+        module.OnInitialize();
+
+        const std::string enabledCapabilities = std::to_string((uint32)AddonCapability::ALL);
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnPreLoadFromDB(benchPlayer.player.get());
+            module.HandleEnableAddon(benchPlayer.session.get(), enabledCapabilities);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+
+        std::vector<std::string> soundEventById;
+        soundEventById.reserve(options.quests);
+        for (uint32 i = 0; i < options.quests; ++i)
+        {
+            const Quest* quest = sObjectMgr.GetQuestTemplate(FIRST_QUEST_ID + i);
+            soundEventById.push_back(std::to_string((uint32)SoundEvent::QUEST_ACCEPT) + ";" + std::to_string(quest->GetQuestId()) + ";;" + quest->GetTitle());
+        }
+
+        printf("Protocol v%u, half of the quests voiced\n", (uint32)AddonProtocol::V2);
+        PrintHeader();
+        Run("HandleSoundEventRequest (id)", iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            module.HandleSoundEventRequest(benchPlayer.session.get(), soundEventById[i % options.quests]);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        const uint32 questLogIterations = std::max(iterations / 20, 1u);
+        for (uint32 i = 0; i < questLogIterations; ++i)
+        {
+            module.HandleQuestLogRequest(players[i % playerCount].session.get(), "");
+            module.OnUpdate(players[i % playerCount].player.get(), 0);
+        }
+
+        Run("HandleQuestLogRequest (snapshot)", questLogIterations, players, [&](uint32 i)
+        {
+            module.HandleQuestLogRequest(players[i % playerCount].session.get(), "");
+            module.OnUpdate(players[i % playerCount].player.get(), 0);
+        });
+
+        printf("\n");
+
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnLogOut(benchPlayer.player.get());
+        }
+
+        std::filesystem::remove(manifestFile);
+    }
+
+    // Startup with an index snapshot file: the first start builds and writes it, the next one maps it
+    void RunSnapshotBenchmarks(const BenchOptions& options, const std::vector<QuestGivers>& questGivers, const std::vector<BenchPlayer>& players)
+    {
+        const uint32 iterations = options.iterations;
+        const uint32 playerCount = options.players;
+
+        const std::string snapshotFile = (std::filesystem::temp_directory_path() / "voiceover_bench_index.bin").string();
+        std::filesystem::remove(snapshotFile);
+
+        VoiceoverModule module;
+        SetConfig(module, "Voiceover.IndexSnapshotFile", snapshotFile);
+        LoadConfig(module, 0);
+
+        printf("Index snapshot\n");
+        PrintHeader();
+        Run("OnInitialize (snapshot write)", 1, players, [&](uint32)
+        {
+            module.OnInitialize();
+        });
+
+        Run("OnInitialize (snapshot map)", 1, players, [&](uint32)
+        {
+            module.OnInitialize();
+        });
+
+        const std::string enabledCapabilities = std::to_string((uint32)AddonCapability::ALL);
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnPreLoadFromDB(benchPlayer.player.get());
+            module.HandleEnableAddon(benchPlayer.session.get(), enabledCapabilities);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+
+        std::vector<std::string> soundEventByTitle;
+        soundEventByTitle.reserve(options.quests);
+        for (uint32 i = 0; i < options.quests; ++i)
+        {
+            soundEventByTitle.push_back(std::to_string((uint32)SoundEvent::QUEST_COMPLETE) + ";0;;" + sObjectMgr.GetQuestTemplate(FIRST_QUEST_ID + i)->GetTitle());
+        }
+
+        Run("HandleSoundEventRequest (title)", iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            const uint32 questIndex = i % options.quests;
+            benchPlayer.player->SetSelectionGuid(questGivers[questIndex].ender);
+            module.HandleSoundEventRequest(benchPlayer.session.get(), soundEventByTitle[questIndex]);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        // The repeatable quests and the ones they repeat, told apart by the fingerprint of the reward text
+        std::vector<uint32> sharedTitleQuests;
+        std::vector<std::string> soundEventByText;
+        for (uint32 i = 20; i < options.quests; i += 20)
+        {
+            for (uint32 questIndex : { i - 1, i })
+            {
+                const Quest* quest = sObjectMgr.GetQuestTemplate(FIRST_QUEST_ID + questIndex);
+                sharedTitleQuests.push_back(questIndex);
+                soundEventByText.push_back(std::to_string((uint32)SoundEvent::QUEST_COMPLETE) + ";0;" +
+                    FormatTextFingerprint(MakeTextFingerprint(quest->GetOfferRewardText())) + ";" + quest->GetTitle());
+            }
+        }
+
+        Run("HandleSoundEventRequest (title+text)", sharedTitleQuests.empty() ? 0 : iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            const uint32 request = i % sharedTitleQuests.size();
+            benchPlayer.player->SetSelectionGuid(questGivers[sharedTitleQuests[request]].ender);
+            module.HandleSoundEventRequest(benchPlayer.session.get(), soundEventByText[request]);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        });
+
+        printf("\n");
+
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnLogOut(benchPlayer.player.get());
+        }
+
+        std::filesystem::remove(snapshotFile);
+    }
+
+    // Creature yells heard by a raid: the players are split in groups of 40, each group alone on its
+    // map around the creature that yells. A yell is looked up and built once for its 40 listeners.
+    void RunCreatureTextBenchmarks(const BenchOptions& options, const std::vector<BenchPlayer>& players)
+    {
+        constexpr uint32 RAID_SIZE = 40;
+        constexpr uint32 FIRST_RAID_MAP = 1000;
+
+        const uint32 iterations = std::max(options.iterations / RAID_SIZE, 1u);
+        const uint32 playerCount = options.players;
+        const uint32 raids = std::min((playerCount + RAID_SIZE - 1) / RAID_SIZE, options.creatures);
+
+        const std::string lookupFile = (std::filesystem::temp_directory_path() / "voiceover_bench_gossip.tsv").string();
+        std::vector<std::string> yells;
+        yells.reserve(raids);
+        {
+            std::ofstream file(lookupFile);
+            for (uint32 i = 0; i < raids; ++i)
+            {
+                yells.push_back(std::string("You dare enter the ") + words[i % (sizeof(words) / sizeof(words[0]))] + " halls? Your bones will join the others!");
+                file << "npc\t" << FIRST_CREATURE_ENTRY + i << "\tyell" << i << "\t" << yells.back() << "\n";
+            }
+        }
+
+        std::vector<Creature> creatures(raids);
+        for (uint32 i = 0; i < raids; ++i)
+        {
+            creatures[i].m_guid = ObjectGuid(HighGuid::HIGHGUID_UNIT, FIRST_CREATURE_ENTRY + i, i + 1);
+            creatures[i].m_mapId = FIRST_RAID_MAP + i;
+        }
+
+        // The raid stands around the creature, each player a few yards further away
+        for (uint32 i = 0; i < playerCount; ++i)
+        {
+            Player* player = players[i].player.get();
+            player->m_mapId = FIRST_RAID_MAP + (i / RAID_SIZE) % raids;
+            player->m_x = (float)(i % RAID_SIZE);
+        }
+
+        VoiceoverModule module;
+        SetConfig(module, "Voiceover.GossipLookupFile", lookupFile);
+        LoadConfig(module, 0);
+        module.OnInitialize();
+
+        // The creature texts are only offered once the core called the creature chat hook
+        module.OnCreatureChat(&creatures[0], CHAT_MSG_MONSTER_SAY, std::string());
+
+        const std::string enabledCapabilities = std::to_string((uint32)AddonCapability::ALL);
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnPreLoadFromDB(benchPlayer.player.get());
+            module.HandleEnableAddon(benchPlayer.session.get(), enabledCapabilities);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+
+        // One yell per world update, followed by the updates of the raid that hears it
+        auto updateRaid = [&](uint32 raid)
+        {
+            module.OnUpdate(0);
+            for (uint32 i = raid * RAID_SIZE; i < std::min((raid + 1) * RAID_SIZE, playerCount); ++i)
+            {
+                module.OnUpdate(players[i].player.get(), 0);
+            }
+        };
+
+        printf("Creature texts, raids of %u players\n", RAID_SIZE);
+        PrintHeader();
+        Run("OnCreatureChat (yell, voiced)", iterations, players, [&](uint32 i)
+        {
+            const uint32 raid = i % raids;
+            module.OnCreatureChat(&creatures[raid], CHAT_MSG_MONSTER_YELL, yells[raid]);
+            updateRaid(raid);
+        });
+
+        // The lines the voice packs don't have are looked up once and dropped
+        const std::string unvoiced = "Intruders! Sound every alarm!";
+        Run("OnCreatureChat (say, unvoiced)", iterations, players, [&](uint32 i)
+        {
+            const uint32 raid = i % raids;
+            module.OnCreatureChat(&creatures[raid], CHAT_MSG_MONSTER_SAY, unvoiced);
+            updateRaid(raid);
+        });
+
+        // Nobody on the map uses the addon, the hook returns without keeping the line
+        Creature outsider;
+        outsider.m_guid = ObjectGuid(HighGuid::HIGHGUID_UNIT, FIRST_CREATURE_ENTRY, raids + 1);
+        outsider.m_mapId = FIRST_RAID_MAP + raids;
+        Run("OnCreatureChat (no listeners)", options.iterations, players, [&](uint32)
+        {
+            module.OnCreatureChat(&outsider, CHAT_MSG_MONSTER_SAY, unvoiced);
+        });
+
+        printf("\n");
+
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnLogOut(benchPlayer.player.get());
+            benchPlayer.player->m_mapId = 0;
+            benchPlayer.player->m_x = 0.0f;
+        }
+
+        std::filesystem::remove(lookupFile);
+    }
+
+    // Players walking into zones: the first time a player enters a zone it gets the zone's quest hints,
+    // the messages of a zone are built once per locale and shared by the players that enter it later.
+    void RunZoneQuestHintBenchmarks(const BenchOptions& options, const std::vector<BenchPlayer>& players)
+    {
+        const uint32 iterations = options.iterations;
+        const uint32 playerCount = options.players;
+
+        VoiceoverModule module;
+        LoadConfig(module, 0);
+        module.OnInitialize();
+
+        const std::string enabledCapabilities = std::to_string((uint32)AddonCapability::ALL);
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnPreLoadFromDB(benchPlayer.player.get());
+            module.HandleEnableAddon(benchPlayer.session.get(), enabledCapabilities);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+
+        // Every player moves to the next zone in turn
+        auto enterZone = [&](uint32 i)
+        {
+            Player* player = players[i % playerCount].player.get();
+            player->m_zoneId = 1 + (i / playerCount) % BENCH_ZONES;
+            module.OnUpdate(player, 0);
+        };
+
+        printf("Zone quest hints, %u zones\n", BENCH_ZONES);
+        PrintHeader();
+        Run("OnUpdate (zone change, first)", iterations, players, enterZone);
+
+        // The same walk again, the players already have the hints of these zones
+        Run("OnUpdate (zone change, known)", iterations, players, enterZone);
+
+        printf("\n");
+
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnLogOut(benchPlayer.player.get());
+            benchPlayer.player->m_zoneId = 0;
+        }
+    }
+
+    volatile uint32 titleFoldSink = 0;
+
+    // Title comparisons as the title lookups do them, against the title as the client sent it in another case.
+    // The localized titles take the multibyte path, the ASCII ones are folded 8 bytes at a time.
+    void RunTitleFoldBenchmarks(const BenchOptions& options, const std::vector<BenchPlayer>& players)
+    {
+        const uint32 iterations = options.iterations;
+
+        std::vector<std::pair<std::string, std::string>> asciiTitles;
+        for (uint32 i = 0; i < std::min(options.quests, 1000u); ++i)
+        {
+            std::string title = sObjectMgr.GetQuestTemplate(FIRST_QUEST_ID + i)->GetTitle();
+            std::string upperTitle = title;
+            for (char& c : upperTitle)
+            {
+                c = (char)toupper((unsigned char)c);
+            }
+
+            asciiTitles.emplace_back(std::move(title), std::move(upperTitle));
+        }
+
+        const std::vector<std::pair<std::string, std::string>> localizedTitles =
+        {
+            { "Die Kronjuwelen von Südsee", "DIE KRONJUWELEN VON SÜDSEE" },
+            { "Le trésor perdu des Élus", "LE TRÉSOR PERDU DES ÉLUS" },
+            { "La señal de la Ciénaga", "LA SEÑAL DE LA CIÉNAGA" },
+            { "Слухи из Чащи Перемен", "СЛУХИ ИЗ ЧАЩИ ПЕРЕМЕН" }
+        };
+
+        uint32 matches = 0;
+        printf("Title folding\n");
+        PrintHeader();
+        Run("IsSameTitle (ASCII)", iterations, players, [&](uint32 i)
+        {
+            const auto& titles = asciiTitles[i % asciiTitles.size()];
+            matches += VoiceoverQuestIndex::IsSameTitle(titles.first, titles.second);
+        });
+
+        Run("IsSameTitle (UTF-8)", iterations, players, [&](uint32 i)
+        {
+            const auto& titles = localizedTitles[i % localizedTitles.size()];
+            matches += VoiceoverQuestIndex::IsSameTitle(titles.first, titles.second);
+        });
+
+        Run("HashTitle (ASCII)", iterations, players, [&](uint32 i)
+        {
+            matches += VoiceoverQuestIndex::HashTitle(asciiTitles[i % asciiTitles.size()].second) & 1;
+        });
+
+        Run("HashTitle (UTF-8)", iterations, players, [&](uint32 i)
+        {
+            matches += VoiceoverQuestIndex::HashTitle(localizedTitles[i % localizedTitles.size()].second) & 1;
+        });
+
+        // Keeps the comparisons from being optimized away
+        titleFoldSink = matches;
+        printf("\n");
+    }
+
+    uint32 ParseArgument(int argc, char* argv[], int index, uint32 defaultValue)
+    {
+        return argc > index ? (uint32)strtoul(argv[index], nullptr, 10) : defaultValue;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Line buffered so the results show up as each benchmark finishes
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    BenchOptions options;
+    options.quests = std::max(ParseArgument(argc, argv, 1, options.quests), 1u);
+    options.creatures = std::max(ParseArgument(argc, argv, 2, options.creatures), 1u);
+    options.players = std::max(ParseArgument(argc, argv, 3, options.players), 1u);
+    options.iterations = ParseArgument(argc, argv, 4, options.iterations);
+
+    printf("Synthetic world: %u quests, %u creatures, %u gameobjects, %u locales, %u players\n",
+        options.quests, options.creatures, options.gameObjects, BENCH_LOCALES, options.players);
+
+    std::vector<QuestGivers> questGivers;
+    std::vector<BenchPlayer> players;
+    GenerateWorld(options, questGivers);
+    GeneratePlayers(options, players);
+
+    const uint32 iterations = options.iterations;
+    const uint32 playerCount = options.players;
+
+    RunHandlerBenchmarks(options, questGivers, players, AddonProtocol::V1);
+    RunHandlerBenchmarks(options, questGivers, players, AddonProtocol::V2);
+    RunManifestBenchmarks(options, players);
+    RunSnapshotBenchmarks(options, questGivers, players);
+    RunCreatureTextBenchmarks(options, players);
+    RunZoneQuestHintBenchmarks(options, players);
+    RunTitleFoldBenchmarks(options, players);
+
+    // Sound events resolved on the worker pool and delivered from the world update
+    const uint32 resolverThreads = std::max(std::thread::hardware_concurrency() / 2, 1u);
+    {
+        VoiceoverModule module;
+        LoadConfig(module, resolverThreads);
+        module.OnInitialize();
+
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnPreLoadFromDB(benchPlayer.player.get());
+            module.HandleEnableAddon(benchPlayer.session.get(), std::to_string((uint32)AddonCapability::ALL));
+            module.OnUpdate(benchPlayer.player.get(), 0);
+        }
+
+        std::vector<std::string> soundEventByTitle;
+        soundEventByTitle.reserve(options.quests);
+        for (uint32 i = 0; i < options.quests; ++i)
+        {
+            soundEventByTitle.push_back(std::to_string((uint32)SoundEvent::QUEST_COMPLETE) + ";0;;" + sObjectMgr.GetQuestTemplate(FIRST_QUEST_ID + i)->GetTitle());
+        }
+
+        const VoiceoverMetrics::Snapshot metricsBefore = module.GetMetrics();
+        const std::string name = "HandleSoundEventRequest (" + std::to_string(resolverThreads) + " workers)";
+        PrintHeader();
+        Run(name.c_str(), iterations, players, [&](uint32 i)
+        {
+            const BenchPlayer& benchPlayer = players[i % playerCount];
+            const uint32 questIndex = i % options.quests;
+            benchPlayer.player->SetSelectionGuid(questGivers[questIndex].ender);
+            module.HandleSoundEventRequest(benchPlayer.session.get(), soundEventByTitle[questIndex]);
+            module.OnUpdate(benchPlayer.player.get(), 0);
+
+            // The world thread delivers the replies every so often, like a world update would
+            if ((i & 0xFF) == 0xFF)
+            {
+                UpdateWorld(module, players);
+            }
+        });
+
+        Run("OnUpdate (drain replies)", 1, players, [&](uint32)
+        {
+            // Wait for the workers to resolve every request, the unresolved ones get no reply
+            const uint64 resolvedBefore = metricsBefore.Get(MetricTimer::SOUND_EVENT_RESOLVE).count;
+            VoiceoverMetrics::Snapshot metricsAfter = module.GetMetrics();
+            while (metricsAfter.Get(MetricTimer::SOUND_EVENT_RESOLVE).count - resolvedBefore < iterations)
+            {
+                UpdateWorld(module, players);
+                std::this_thread::yield();
+                metricsAfter = module.GetMetrics();
+            }
+
+            // The last replies may still be on their way to the reply queue, they are all sent once it stays empty
+            uint32 idleUpdates = 0;
+            while (idleUpdates < 3)
+            {
+                idleUpdates = module.GetQueuedReplies() == 0 ? idleUpdates + 1 : 0;
+                UpdateWorld(module, players);
+                std::this_thread::yield();
+            }
+        });
+
+        printf("\n");
+        // Without a session the module metrics are written to the log
+        module.HandleStatsRequest(nullptr, "");
+
+        for (const BenchPlayer& benchPlayer : players)
+        {
+            module.OnLogOut(benchPlayer.player.get());
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,575 @@
+// Plays back a trace of addon commands recorded with ".voiceover trace" against the module.
+//
+// Every player of the trace becomes one or more synthetic sessions (the copies scale the load
+// up) and every command is fed through the same chat command table the core uses, at the
+// recorded pace sped up by the given factor. The world is derived from the trace itself: the
+// quests, titles and quest givers referenced by the sound events are created in the stubbed
+// object manager with filler quest texts, and the players carry the quests they asked about.
+//
+// Reports the handler latency distribution per command, the depth of the resolver and reply
+// queues sampled every world update, the outbound addon traffic and how far the replay fell
+// behind the trace schedule.
+//
+//   voiceover_replay <trace> [speed] [copies] [resolverThreads]
+//   voiceover_replay --generate <trace> [players] [seconds]
+
+#include "VoiceoverModule.h"
+
+#include "Globals/ObjectAccessor.h"
+#include "Globals/ObjectMgr.h"
+#include "Server/SQLStorages.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+#include <tuple>
+
+using namespace cmangos_module;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // How often the replay runs a world update, like the core's default world tick
+    constexpr uint32 WORLD_UPDATE_INTERVAL = 50;
+
+    // Copies of a player start at a random offset within this many microseconds
+    constexpr uint64 COPY_SPREAD = 1000000;
+
+    // Quests asked for by title only get ids from here on
+    constexpr uint32 FIRST_SYNTHETIC_QUEST_ID = 1000000;
+
+    // Stand-in quest texts of about the average length of the real ones
+    const char* const fillerDetails =
+        "The wolves of the forest have grown bold of late, attacking travelers on the road and carrying off "
+        "livestock from the farms nearby. The guards can't spare anyone while the gnolls press the border, so it "
+        "falls to adventurers like you. Hunt down the pack leader in the hills to the east and bring me proof of "
+        "the deed. Take care, the beast is larger than the rest and it does not hunt alone.";
+    const char* const fillerObjectives = "Bring the fang of the pack leader to the warden at the crossroads.";
+    const char* const fillerRequestItems = "Have you dealt with the wolves yet? The farmers grow more worried with every passing night.";
+    const char* const fillerOfferReward = "You have done well. The roads will be safer now, and the farmers will sleep easier. Take this as thanks.";
+
+    struct ReplayPlayer
+    {
+        std::unique_ptr<WorldSession> session;
+        std::unique_ptr<Player> player;
+    };
+
+    struct ReplayEvent
+    {
+        uint64 time;
+        uint32 record;
+        uint32 player;
+
+        bool operator<(const ReplayEvent& other) const { return time < other.time; }
+    };
+
+    // Nanosecond samples of one command, sorted when the percentiles are read
+    struct LatencySamples
+    {
+        std::vector<uint64> samples;
+
+        double GetPercentile(double percentile)
+        {
+            if (samples.empty())
+            {
+                return 0.0;
+            }
+
+            const size_t index = std::min(samples.size() - 1, (size_t)(percentile / 100.0 * samples.size()));
+            std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+            return samples[index] / 1000.0;
+        }
+    };
+
+    struct QueueDepth
+    {
+        uint64 total = 0;
+        size_t max = 0;
+
+        void Add(size_t depth)
+        {
+            total += depth;
+            max = std::max(max, depth);
+        }
+    };
+
+    // Owns the names the creature and gameobject templates point to
+    std::vector<std::unique_ptr<char[]>> templateNames;
+
+    bool IsQuestEvent(uint32 eventType)
+    {
+        return eventType == (uint32)SoundEvent::QUEST_ACCEPT || eventType == (uint32)SoundEvent::QUEST_PROGRESS || eventType == (uint32)SoundEvent::QUEST_COMPLETE;
+    }
+
+    void AddQuestGiver(const ObjectGuid& giver)
+    {
+        const uint32 entry = giver.GetEntry();
+        if (giver.IsCreature() && !sCreatureStorage.LookupEntry<CreatureInfo>(entry))
+        {
+            templateNames.emplace_back(mangos_strdup(("Creature " + std::to_string(entry)).c_str()));
+            sCreatureStorage.Add(CreatureInfo{ entry, templateNames.back().get() }, entry);
+        }
+        else if (giver.IsGameObject() && !sGOStorage.LookupEntry<GameObjectInfo>(entry))
+        {
+            templateNames.emplace_back(mangos_strdup(("Object " + std::to_string(entry)).c_str()));
+            sGOStorage.Add(GameObjectInfo{ entry, templateNames.back().get() }, entry);
+        }
+    }
+
+    void AddQuest(uint32 questId, const std::string& title)
+    {
+        std::unique_ptr<Quest>& quest = sObjectMgr.mQuestTemplates[questId];
+        if (!quest)
+        {
+            quest = std::make_unique<Quest>();
+            quest->QuestId = questId;
+            quest->Title = "Quest " + std::to_string(questId);
+            quest->Details = fillerDetails;
+            quest->Objectives = fillerObjectives;
+            quest->RequestItemsText = fillerRequestItems;
+            quest->OfferRewardText = fillerOfferReward;
+        }
+
+        if (!title.empty())
+        {
+            quest->Title = title;
+        }
+    }
+
+    // Creates what the sound events of the trace refer to and fills the quest logs of the players
+    void BuildWorld(const std::vector<TraceRecord>& records, std::map<uint32, std::set<uint32>>& questLogs)
+    {
+        std::map<std::pair<std::string, uint64>, uint32> titleQuests;
+        std::set<std::tuple<uint32, uint32, uint32>> relations;
+        uint32 nextQuestId = FIRST_SYNTHETIC_QUEST_ID;
+
+        // The quest titles of the players whose addon sends text fingerprints come after them
+        std::map<uint32, uint32> capabilities;
+
+        for (const TraceRecord& record : records)
+        {
+            if (record.command == AddonCommand::ENABLE_ADDON)
+            {
+                capabilities[record.playerId] = ParseEnableAddonArgs(record.args).capabilities;
+                continue;
+            }
+
+            SoundEventArgs soundEvent;
+            if (record.command != AddonCommand::SOUND_EVENT || !ParseSoundEventArgs(record.args, soundEvent) || !IsQuestEvent(soundEvent.eventType))
+            {
+                continue;
+            }
+
+            const uint32 eventType = soundEvent.eventType;
+            const std::string title(capabilities[record.playerId] & (uint32)AddonCapability::QUEST_TEXT_FINGERPRINTS ? ParseQuestTitleArgs(soundEvent.text).title : soundEvent.text);
+            uint32 questId = soundEvent.id;
+
+            const ObjectGuid giver(record.targetGuid);
+            if (questId == 0)
+            {
+                // The same title asked of the same giver is the same quest
+                const auto titleIt = titleQuests.emplace(std::make_pair(title, giver.IsCreature() || giver.IsGameObject() ? giver.GetRawValue() & ~0xFFFFFFull : 0), nextQuestId);
+                if (titleIt.second)
+                {
+                    nextQuestId++;
+                }
+
+                questId = titleIt.first->second;
+            }
+
+            AddQuest(questId, title);
+            questLogs[record.playerId].insert(questId);
+
+            if (giver.IsCreature() || giver.IsGameObject())
+            {
+                AddQuestGiver(giver);
+
+                const uint32 relation = (giver.IsGameObject() ? 2 : 0) + (eventType == (uint32)SoundEvent::QUEST_ACCEPT ? 0 : 1);
+                if (relations.emplace(relation, giver.GetEntry(), questId).second)
+                {
+                    QuestRelationsMap* relationMaps[] = { &sObjectMgr.m_CreatureQuestRelations, &sObjectMgr.m_CreatureQuestInvolvedRelations, &sObjectMgr.m_GOQuestRelations, &sObjectMgr.m_GOQuestInvolvedRelations };
+                    relationMaps[relation]->insert({ giver.GetEntry(), questId });
+                }
+            }
+        }
+
+        printf("World from the trace: %u quests (%u asked for by title only), %u quest relations\n",
+            (uint32)sObjectMgr.mQuestTemplates.size(), nextQuestId - FIRST_SYNTHETIC_QUEST_ID, (uint32)relations.size());
+    }
+
+    void SetConfig(VoiceoverModule& module, const char* name, const std::string& value)
+    {
+        ModuleConfig* config = const_cast<VoiceoverModuleConfig*>(module.GetConfig());
+        config->config.Set(name, value);
+    }
+
+    uint64 GetSentBytes(const std::vector<ReplayPlayer>& players, uint64* packets)
+    {
+        uint64 bytes = 0;
+        *packets = 0;
+        for (const ReplayPlayer& replayPlayer : players)
+        {
+            bytes += replayPlayer.session->GetSentBytes();
+            *packets += replayPlayer.session->GetSentPackets();
+        }
+
+        return bytes;
+    }
+
+    int Replay(const std::string& traceFile, double speed, uint32 copies, uint32 resolverThreads)
+    {
+        std::vector<TraceRecord> records;
+        {
+            VoiceoverTraceReader reader;
+            if (!reader.Open(traceFile))
+            {
+                return 1;
+            }
+
+            TraceRecord record;
+            while (reader.Next(record))
+            {
+                records.push_back(record);
+            }
+        }
+
+        if (records.empty())
+        {
+            printf("The trace %s has no records\n", traceFile.c_str());
+            return 1;
+        }
+
+        std::map<uint32, std::set<uint32>> questLogs;
+        BuildWorld(records, questLogs);
+
+        // Every recorded player is played by the given number of sessions
+        std::map<uint32, uint32> firstPlayerIndex;
+        std::map<uint32, int> playerLocales;
+        for (const TraceRecord& record : records)
+        {
+            playerLocales.emplace(record.playerId, record.localeIndex);
+        }
+
+        std::vector<ReplayPlayer> players;
+        players.reserve(playerLocales.size() * copies);
+        for (uint32 copy = 0; copy < copies; ++copy)
+        {
+            for (const auto& playerLocale : playerLocales)
+            {
+                const uint32 index = (uint32)players.size();
+                if (copy == 0)
+                {
+                    firstPlayerIndex[playerLocale.first] = index;
+                }
+
+                players.emplace_back();
+                ReplayPlayer& replayPlayer = players.back();
+                replayPlayer.session = std::make_unique<WorldSession>(index + 1, playerLocale.second);
+                replayPlayer.player = std::make_unique<Player>(replayPlayer.session.get());
+                replayPlayer.player->m_guid = ObjectGuid(HighGuid::HIGHGUID_PLAYER, index + 1);
+                replayPlayer.session->SetPlayer(replayPlayer.player.get());
+
+                uint16 slot = 0;
+                for (const uint32 questId : questLogs[playerLocale.first])
+                {
+                    if (slot < MAX_QUEST_LOG_SIZE)
+                    {
+                        replayPlayer.player->SetQuestSlot(slot++, questId);
+                    }
+                }
+
+                sObjectAccessor.players[replayPlayer.player->GetObjectGuid().GetRawValue()] = replayPlayer.player.get();
+            }
+        }
+
+        std::vector<ReplayEvent> events;
+        events.reserve(records.size() * copies);
+        std::mt19937 rng(777);
+        std::uniform_int_distribution<uint64> copyOffset(0, COPY_SPREAD - 1);
+        const uint32 tracePlayers = (uint32)playerLocales.size();
+        std::vector<uint64> offsets(players.size());
+        for (uint32 i = tracePlayers; i < players.size(); ++i)
+        {
+            offsets[i] = copyOffset(rng);
+        }
+
+        for (uint32 i = 0; i < records.size(); ++i)
+        {
+            const uint32 firstIndex = firstPlayerIndex[records[i].playerId];
+            for (uint32 copy = 0; copy < copies; ++copy)
+            {
+                const uint32 playerIndex = firstIndex + copy * tracePlayers;
+                events.push_back({ records[i].time + offsets[playerIndex], i, playerIndex });
+            }
+        }
+
+        std::stable_sort(events.begin(), events.end());
+
+        // The rate limit and dedupe window are kept as configured, they are part of what is measured
+        VoiceoverModule module;
+        SetConfig(module, "Voiceover.Enable", "1");
+        SetConfig(module, "Voiceover.StatsLogInterval", "0");
+        SetConfig(module, "Voiceover.ResolverThreads", std::to_string(resolverThreads));
+        module.LoadConfig();
+        module.OnInitialize();
+
+        for (const ReplayPlayer& replayPlayer : players)
+        {
+            module.OnPreLoadFromDB(replayPlayer.player.get());
+        }
+
+        std::function<bool(WorldSession*, const std::string&)> handlers[(uint8)AddonCommand::MAX];
+        for (const ModuleChatCommand& command : *module.GetCommandTable())
+        {
+            for (uint8 i = 1; i < (uint8)AddonCommand::MAX; ++i)
+            {
+                if (GetAddonCommandName((AddonCommand)i) == command.name)
+                {
+                    handlers[i] = command.handler;
+                }
+            }
+        }
+
+        const uint64 traceDuration = records.back().time;
+        printf("Replaying %u commands of %u players (%.1f s) at %.1fx with %u copies of each player, %u resolver threads\n",
+            (uint32)events.size(), tracePlayers, traceDuration / 1e6, speed, copies, resolverThreads);
+
+        LatencySamples latencies[(uint8)AddonCommand::MAX];
+        QueueDepth resolverQueue;
+        QueueDepth replyQueue;
+        uint64 updates = 0;
+        uint64 maxLag = 0;
+        uint64 peakBytesPerSecond = 0;
+        uint64 secondBytes = 0;
+
+        const Clock::time_point start = Clock::now();
+        Clock::time_point nextUpdate = start + std::chrono::milliseconds(WORLD_UPDATE_INTERVAL);
+        Clock::time_point lastUpdate = start;
+        Clock::time_point secondStart = start;
+
+        auto worldUpdate = [&](Clock::time_point now)
+        {
+            resolverQueue.Add(module.GetQueuedSoundEvents());
+            replyQueue.Add(module.GetQueuedReplies());
+            const uint32 elapsed = (uint32)std::chrono::duration_cast<std::chrono::milliseconds>(now - lastUpdate).count();
+            module.OnUpdate(elapsed);
+            for (const ReplayPlayer& replayPlayer : players)
+            {
+                module.OnUpdate(replayPlayer.player.get(), elapsed);
+            }
+
+            lastUpdate = now;
+            updates++;
+
+            if (now - secondStart >= std::chrono::seconds(1))
+            {
+                uint64 packets = 0;
+                const uint64 bytes = GetSentBytes(players, &packets);
+                peakBytesPerSecond = std::max(peakBytesPerSecond, bytes - secondBytes);
+                secondBytes = bytes;
+                secondStart = now;
+            }
+        };
+
+        for (const ReplayEvent& event : events)
+        {
+            const Clock::time_point due = start + std::chrono::microseconds((uint64)(event.time / speed));
+            Clock::time_point now = Clock::now();
+            while (now < due)
+            {
+                if (now >= nextUpdate)
+                {
+                    worldUpdate(now);
+                    nextUpdate += std::chrono::milliseconds(WORLD_UPDATE_INTERVAL);
+                }
+
+                std::this_thread::sleep_until(std::min(due, nextUpdate));
+                now = Clock::now();
+            }
+
+            if (now >= nextUpdate)
+            {
+                worldUpdate(now);
+                nextUpdate = now + std::chrono::milliseconds(WORLD_UPDATE_INTERVAL);
+            }
+
+            maxLag = std::max<uint64>(maxLag, std::chrono::duration_cast<std::chrono::microseconds>(now - due).count());
+
+            const TraceRecord& record = records[event.record];
+            const ReplayPlayer& replayPlayer = players[event.player];
+            const auto& handler = handlers[(uint8)record.command];
+            if (handler)
+            {
+                replayPlayer.player->SetSelectionGuid(ObjectGuid(record.targetGuid));
+
+                const Clock::time_point handlerStart = Clock::now();
+                handler(replayPlayer.session.get(), record.args);
+                latencies[(uint8)record.command].samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - handlerStart).count());
+            }
+        }
+
+        // Deliver what the workers are still resolving
+        const Clock::time_point replayEnd = Clock::now();
+        uint32 idleUpdates = 0;
+        while (idleUpdates < 3)
+        {
+            const bool idle = module.GetQueuedSoundEvents() == 0 && module.GetQueuedReplies() == 0;
+            idleUpdates = idle ? idleUpdates + 1 : 0;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            worldUpdate(Clock::now());
+        }
+
+        const double seconds = std::chrono::duration<double>(replayEnd - start).count();
+        uint64 packets = 0;
+        const uint64 bytes = GetSentBytes(players, &packets);
+
+        printf("\nReplayed in %.2f s (%.0f commands/s), fell behind the schedule by up to %.2f ms\n",
+            seconds, seconds > 0.0 ? events.size() / seconds : 0.0, maxLag / 1000.0);
+
+        printf("\n%-12s %10s %10s %10s %10s %10s %10s\n", "command", "calls", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+        for (uint8 i = 1; i < (uint8)AddonCommand::MAX; ++i)
+        {
+            LatencySamples& samples = latencies[i];
+            printf("%-12s %10u %10.1f %10.1f %10.1f %10.1f %10.1f\n", GetAddonCommandName((AddonCommand)i).data(), (uint32)samples.samples.size(),
+                samples.GetPercentile(50), samples.GetPercentile(90), samples.GetPercentile(99), samples.GetPercentile(99.9), samples.GetPercentile(100));
+        }
+
+        printf("\nQueue depths over %llu world updates: resolver avg %.1f max %u, replies avg %.1f max %u\n", (unsigned long long)updates,
+            updates ? (double)resolverQueue.total / updates : 0.0, (uint32)resolverQueue.max,
+            updates ? (double)replyQueue.total / updates : 0.0, (uint32)replyQueue.max);
+        printf("Outbound: %llu packets, %llu bytes (%.0f bytes/s on average, %llu in the busiest second)\n\n",
+            (unsigned long long)packets, (unsigned long long)bytes, seconds > 0.0 ? bytes / seconds : 0.0, (unsigned long long)peakBytesPerSecond);
+
+        // Without a session the module metrics are written to the log
+        module.HandleStatsRequest(nullptr, "");
+
+        for (const ReplayPlayer& replayPlayer : players)
+        {
+            module.OnLogOut(replayPlayer.player.get());
+        }
+
+        return 0;
+    }
+
+    const char* const words[] =
+    {
+        "lost", "hunt", "shadow", "blood", "wolves", "tome", "crown", "ancient", "stone", "fire", "river", "keeper",
+        "darkshire", "goldshire", "supplies", "warden", "cursed", "relic", "spider", "murloc", "elder", "spirit"
+    };
+
+    std::string MakeQuestTitle(uint32 questId)
+    {
+        const uint32 wordCount = (uint32)(sizeof(words) / sizeof(words[0]));
+        return std::string("The ") + words[questId % wordCount] + " of " + words[(questId / wordCount) % wordCount] + " " + std::to_string(questId % 7);
+    }
+
+    // A plausible session mix: each player enables the addon, syncs the quest log and then asks
+    // for a sound event every 15 seconds on average, mostly quests by id, some by title and gossip
+    int Generate(const std::string& traceFile, uint32 playerCount, uint32 seconds)
+    {
+        const uint32 questCount = 2000;
+        const uint32 creatureCount = 5000;
+        const uint64 duration = (uint64)seconds * 1000000;
+
+        std::mt19937 rng(4242);
+        std::uniform_int_distribution<uint64> loginTime(0, std::min<uint64>(duration, 5000000));
+        std::exponential_distribution<double> eventInterval(1.0 / 15.0);
+        std::uniform_int_distribution<uint32> questId(1, questCount);
+        std::uniform_int_distribution<uint32> percent(0, 99);
+        std::uniform_int_distribution<int> localeIndex(-1, 7);
+
+        std::vector<TraceRecord> records;
+        for (uint32 playerId = 1; playerId <= playerCount; ++playerId)
+        {
+            TraceRecord record;
+            record.playerId = playerId;
+            record.localeIndex = localeIndex(rng);
+            record.time = loginTime(rng);
+            record.command = AddonCommand::ENABLE_ADDON;
+            record.args = std::to_string((uint32)AddonCapability::ALL);
+            records.push_back(record);
+
+            record.time += 100000;
+            record.command = AddonCommand::QUEST_LOG;
+            record.args.clear();
+            records.push_back(record);
+
+            record.command = AddonCommand::SOUND_EVENT;
+            while ((record.time += (uint64)(eventInterval(rng) * 1e6)) < duration)
+            {
+                const uint32 quest = questId(rng);
+                const uint32 roll = percent(rng);
+                if (roll < 40)
+                {
+                    record.targetGuid = ObjectGuid(HighGuid::HIGHGUID_UNIT, quest * 7 % creatureCount + 1, quest).GetRawValue();
+                    record.args = std::to_string((uint32)SoundEvent::QUEST_ACCEPT) + ";" + std::to_string(quest) + ";;" + MakeQuestTitle(quest);
+                }
+                else if (roll < 60)
+                {
+                    record.targetGuid = ObjectGuid(HighGuid::HIGHGUID_UNIT, quest * 11 % creatureCount + 1, quest).GetRawValue();
+                    record.args = std::to_string((uint32)SoundEvent::QUEST_PROGRESS) + ";" + std::to_string(quest) + ";;" + MakeQuestTitle(quest);
+                }
+                else if (roll < 90)
+                {
+                    record.targetGuid = ObjectGuid(HighGuid::HIGHGUID_UNIT, quest * 11 % creatureCount + 1, quest).GetRawValue();
+                    record.args = std::to_string((uint32)SoundEvent::QUEST_COMPLETE) + ";0;;" + MakeQuestTitle(quest);
+                }
+                else
+                {
+                    record.targetGuid = ObjectGuid(HighGuid::HIGHGUID_UNIT, quest % creatureCount + 1, quest).GetRawValue();
+                    record.args = std::to_string((uint32)SoundEvent::GOSSIP) + ";0;Greetings, traveler. " + MakeQuestTitle(quest) + " is not for the faint of heart.";
+                }
+
+                records.push_back(record);
+            }
+        }
+
+        std::stable_sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) { return a.time < b.time; });
+
+        VoiceoverTraceRecorder recorder;
+        if (!recorder.Start(traceFile))
+        {
+            return 1;
+        }
+
+        for (const TraceRecord& record : records)
+        {
+            recorder.Write(record);
+        }
+
+        printf("Generated %llu commands of %u players over %u s in %s\n", (unsigned long long)recorder.Stop(), playerCount, seconds, traceFile.c_str());
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Line buffered so the module log and the results stay in order
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    if (argc >= 3 && strcmp(argv[1], "--generate") == 0)
+    {
+        const uint32 playerCount = argc > 3 ? std::max((uint32)strtoul(argv[3], nullptr, 10), 1u) : 1000;
+        const uint32 seconds = argc > 4 ? std::max((uint32)strtoul(argv[4], nullptr, 10), 1u) : 60;
+        return Generate(argv[2], playerCount, seconds);
+    }
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <trace> [speed] [copies] [resolverThreads]\n", argv[0]);
+        printf("       %s --generate <trace> [players] [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    const double speed = argc > 2 ? std::max(strtod(argv[2], nullptr), 0.001) : 1.0;
+    const uint32 copies = argc > 3 ? std::max((uint32)strtoul(argv[3], nullptr, 10), 1u) : 1;
+    const uint32 resolverThreads = argc > 4 ? (uint32)strtoul(argv[4], nullptr, 10) : std::max(std::thread::hardware_concurrency() / 2, 1u);
+    return Replay(argv[1], speed, copies, resolverThreads);
+}
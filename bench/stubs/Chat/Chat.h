@@ -0,0 +1,83 @@
+#ifndef VOICEOVER_BENCH_STUB_CHAT_H
+#define VOICEOVER_BENCH_STUB_CHAT_H
+
+#include "Server/WorldSession.h"
+#include "Entities/ObjectGuid.h"
+
+enum ChatMsg
+{
+    CHAT_MSG_ADDON = 0xFFFFFFFF,
+    CHAT_MSG_SYSTEM = 0x00,
+    CHAT_MSG_SAY = 0x01,
+    CHAT_MSG_PARTY = 0x02,
+    CHAT_MSG_RAID = 0x03,
+    CHAT_MSG_GUILD = 0x04,
+    CHAT_MSG_YELL = 0x06,
+    CHAT_MSG_WHISPER = 0x07,
+    CHAT_MSG_MONSTER_SAY = 0x0B,
+    CHAT_MSG_MONSTER_YELL = 0x0C,
+    CHAT_MSG_MONSTER_WHISPER = 0x0D,
+    CHAT_MSG_MONSTER_EMOTE = 0x0E
+};
+
+enum Language
+{
+    LANG_UNIVERSAL = 0,
+    LANG_ADDON = 0xFFFFFFFF
+};
+
+enum ChatTagFlags
+{
+    CHAT_TAG_NONE = 0x00
+};
+
+class ChatHandler
+{
+public:
+    explicit ChatHandler(WorldSession* session) : m_session(session) {}
+
+    static char* LineFromMessage(char*& pos)
+    {
+        char* start = std::strtok(pos, "\n");
+        pos = nullptr;
+        return start;
+    }
+
+    static void BuildChatPacket(WorldPacket& data, ChatMsg msgtype, const char* message, Language language = LANG_UNIVERSAL,
+        ChatTagFlags chatTag = CHAT_TAG_NONE, const ObjectGuid& senderGuid = ObjectGuid(), const char* senderName = nullptr,
+        const ObjectGuid& targetGuid = ObjectGuid(), const char* channelName = nullptr)
+    {
+        (void)chatTag; (void)senderName; (void)channelName;
+        data.Initialize(SMSG_MESSAGECHAT, 100);
+        data << uint8(msgtype);
+        data << uint32(language);
+        data << senderGuid.GetRawValue();
+        data << targetGuid.GetRawValue();
+        data << uint32(std::strlen(message) + 1);
+        data << message;
+        data << uint8(0);
+    }
+
+    void SendSysMessage(const char* str)
+    {
+        WorldPacket data;
+        BuildChatPacket(data, CHAT_MSG_SYSTEM, str);
+        if (m_session)
+            m_session->SendPacket(data);
+    }
+
+    void PSendSysMessage(const char* format, ...)
+    {
+        va_list ap;
+        char str[2048];
+        va_start(ap, format);
+        vsnprintf(str, 2048, format, ap);
+        va_end(ap);
+        SendSysMessage(str);
+    }
+
+private:
+    WorldSession* m_session;
+};
+
+#endif
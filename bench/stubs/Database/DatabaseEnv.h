@@ -0,0 +1,49 @@
+#ifndef VOICEOVER_BENCH_STUB_DATABASEENV_H
+#define VOICEOVER_BENCH_STUB_DATABASEENV_H
+
+#include "StubCommon.h"
+
+class Field
+{
+public:
+    uint32 GetUInt32() const { return value; }
+    uint32 value = 0;
+};
+
+class QueryResult
+{
+public:
+    Field* Fetch() { return fields.data(); }
+    bool NextRow() { return false; }
+    std::vector<Field> fields;
+};
+
+// Statements are only counted, queries never return rows
+class Database
+{
+public:
+    Database() : m_queries(0), m_executes(0) {}
+
+    std::unique_ptr<QueryResult> PQuery(const char* /*format*/, ...)
+    {
+        ++m_queries;
+        return nullptr;
+    }
+
+    bool PExecute(const char* /*format*/, ...)
+    {
+        ++m_executes;
+        return true;
+    }
+
+    uint64 GetQueryCount() const { return m_queries; }
+    uint64 GetExecuteCount() const { return m_executes; }
+
+private:
+    uint64 m_queries;
+    uint64 m_executes;
+};
+
+inline Database CharacterDatabase;
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef VOICEOVER_BENCH_STUB_CREATURE_H
+#define VOICEOVER_BENCH_STUB_CREATURE_H
+
+#include "Entities/Object.h"
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef VOICEOVER_BENCH_STUB_GOSSIPDEF_H
+#define VOICEOVER_BENCH_STUB_GOSSIPDEF_H
+
+#include "StubCommon.h"
+
+enum QuestGiverStatus
+{
+    DIALOG_STATUS_NONE = 0,
+    DIALOG_STATUS_UNAVAILABLE = 1,
+    DIALOG_STATUS_CHAT = 2,
+    DIALOG_STATUS_INCOMPLETE = 3,
+    DIALOG_STATUS_REWARD_REP = 4,
+    DIALOG_STATUS_AVAILABLE = 5,
+    DIALOG_STATUS_REWARD_OLD = 6,
+    DIALOG_STATUS_REWARD2 = 7
+};
+
+struct QuestMenuItem
+{
+    uint32 m_qId;
+    uint8 m_qIcon;
+};
+
+class QuestMenu
+{
+public:
+    void AddMenuItem(uint32 QuestId, uint8 Icon) { m_qItems.push_back({ QuestId, Icon }); }
+    void ClearMenu() { m_qItems.clear(); }
+    uint32 MenuItemCount() const { return uint32(m_qItems.size()); }
+    bool Empty() const { return m_qItems.empty(); }
+    const QuestMenuItem& GetItem(uint16 Id) const { return m_qItems[Id]; }
+
+private:
+    std::vector<QuestMenuItem> m_qItems;
+};
+
+class PlayerMenu
+{
+public:
+    QuestMenu& GetQuestMenu() { return mQuestMenu; }
+
+private:
+    QuestMenu mQuestMenu;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef VOICEOVER_BENCH_STUB_OBJECT_H
+#define VOICEOVER_BENCH_STUB_OBJECT_H
+
+#include "StubCommon.h"
+#include "Entities/ObjectGuid.h"
+
+class WorldObject
+{
+public:
+    WorldObject() : m_mapId(0), m_instanceId(0), m_zoneId(0), m_areaId(0), m_x(0.0f), m_y(0.0f), m_z(0.0f) {}
+    virtual ~WorldObject() {}
+
+    const ObjectGuid& GetObjectGuid() const { return m_guid; }
+    uint32 GetEntry() const { return m_guid.GetEntry(); }
+    const char* GetName() const { return m_name.c_str(); }
+    uint32 GetMapId() const { return m_mapId; }
+    uint32 GetInstanceId() const { return m_instanceId; }
+    uint32 GetZoneId() const { return m_zoneId; }
+    uint32 GetAreaId() const { return m_areaId; }
+    float GetPositionX() const { return m_x; }
+    float GetPositionY() const { return m_y; }
+    float GetPositionZ() const { return m_z; }
+
+    bool IsInMap(const WorldObject* obj) const { return obj && m_mapId == obj->m_mapId && m_instanceId == obj->m_instanceId; }
+    bool IsWithinDist(const WorldObject* obj, float dist2compare) const
+    {
+        const float dx = m_x - obj->m_x;
+        const float dy = m_y - obj->m_y;
+        const float dz = m_z - obj->m_z;
+        return (dx * dx + dy * dy + dz * dz) <= dist2compare * dist2compare;
+    }
+
+public:
+    ObjectGuid m_guid;
+    std::string m_name;
+    uint32 m_mapId;
+    uint32 m_instanceId;
+    uint32 m_zoneId;
+    uint32 m_areaId;
+    float m_x, m_y, m_z;
+};
+
+class Unit : public WorldObject {};
+
+class Creature : public Unit {};
+
+class GameObject : public WorldObject {};
+
+#endif
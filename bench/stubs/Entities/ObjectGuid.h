@@ -0,0 +1,59 @@
+#ifndef VOICEOVER_BENCH_STUB_OBJECTGUID_H
+#define VOICEOVER_BENCH_STUB_OBJECTGUID_H
+
+#include "StubCommon.h"
+
+enum class HighGuid : uint16
+{
+    HIGHGUID_ITEM = 0x4000,
+    HIGHGUID_CONTAINER = 0x4000,
+    HIGHGUID_PLAYER = 0x0000,
+    HIGHGUID_GAMEOBJECT = 0xF110,
+    HIGHGUID_TRANSPORT = 0xF120,
+    HIGHGUID_UNIT = 0xF130,
+    HIGHGUID_PET = 0xF140,
+    HIGHGUID_DYNAMICOBJECT = 0xF100,
+    HIGHGUID_CORPSE = 0xF101,
+    HIGHGUID_MO_TRANSPORT = 0x1FC0
+};
+
+class ObjectGuid
+{
+public:
+    ObjectGuid() : m_guid(0) {}
+    explicit ObjectGuid(uint64 guid) : m_guid(guid) {}
+    ObjectGuid(HighGuid hi, uint32 entry, uint32 counter)
+    : m_guid(counter ? uint64(counter) | (uint64(entry) << 24) | (uint64(hi) << 48) : 0) {}
+    ObjectGuid(HighGuid hi, uint32 counter)
+    : m_guid(counter ? uint64(counter) | (uint64(hi) << 48) : 0) {}
+
+    uint64 GetRawValue() const { return m_guid; }
+    bool IsEmpty() const { return m_guid == 0; }
+    HighGuid GetHigh() const { return HighGuid((m_guid >> 48) & 0xFFFF); }
+    bool HasEntry() const
+    {
+        switch (GetHigh())
+        {
+            case HighGuid::HIGHGUID_UNIT:
+            case HighGuid::HIGHGUID_PET:
+            case HighGuid::HIGHGUID_GAMEOBJECT:
+                return true;
+            default:
+                return false;
+        }
+    }
+    uint32 GetEntry() const { return HasEntry() ? uint32((m_guid >> 24) & 0xFFFFFF) : 0; }
+    uint32 GetCounter() const { return HasEntry() ? uint32(m_guid & 0xFFFFFF) : uint32(m_guid & 0xFFFFFFFF); }
+    bool IsPlayer() const { return !IsEmpty() && GetHigh() == HighGuid::HIGHGUID_PLAYER; }
+    bool IsCreature() const { return GetHigh() == HighGuid::HIGHGUID_UNIT; }
+    bool IsGameObject() const { return GetHigh() == HighGuid::HIGHGUID_GAMEOBJECT; }
+    bool IsItem() const { return GetHigh() == HighGuid::HIGHGUID_ITEM; }
+
+    bool operator==(const ObjectGuid& other) const { return m_guid == other.m_guid; }
+    bool operator!=(const ObjectGuid& other) const { return m_guid != other.m_guid; }
+
+private:
+    uint64 m_guid;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef VOICEOVER_BENCH_STUB_PLAYER_H
+#define VOICEOVER_BENCH_STUB_PLAYER_H
+
+#include "Entities/Object.h"
+#include "Entities/GossipDef.h"
+#include "Server/WorldSession.h"
+
+#define MAX_QUEST_LOG_SIZE 20
+
+class Player : public Unit
+{
+public:
+    explicit Player(WorldSession* session) : m_session(session), m_realPlayer(true)
+    {
+        std::fill(std::begin(m_questSlots), std::end(m_questSlots), 0);
+    }
+
+    WorldSession* GetSession() const { return m_session; }
+    PlayerMenu* GetPlayerMenu() const { return const_cast<PlayerMenu*>(&m_playerMenu); }
+    const ObjectGuid& GetSelectionGuid() const { return m_selectionGuid; }
+    void SetSelectionGuid(const ObjectGuid& guid) { m_selectionGuid = guid; }
+    uint32 GetQuestSlotQuestId(uint16 slot) const { return m_questSlots[slot]; }
+    void SetQuestSlot(uint16 slot, uint32 questId) { m_questSlots[slot] = questId; }
+    bool isRealPlayer() const { return m_realPlayer; }
+
+private:
+    WorldSession* m_session;
+    PlayerMenu m_playerMenu;
+    ObjectGuid m_selectionGuid;
+    uint32 m_questSlots[MAX_QUEST_LOG_SIZE];
+    bool m_realPlayer;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef VOICEOVER_BENCH_STUB_OBJECTACCESSOR_H
+#define VOICEOVER_BENCH_STUB_OBJECTACCESSOR_H
+
+#include "Entities/Player.h"
+
+class ObjectAccessor
+{
+public:
+    static ObjectAccessor& Instance() { static ObjectAccessor instance; return instance; }
+
+    static Player* FindPlayer(const ObjectGuid& guid, bool /*inWorld*/ = true)
+    {
+        auto itr = Instance().players.find(guid.GetRawValue());
+        return itr != Instance().players.end() ? itr->second : nullptr;
+    }
+
+    std::unordered_map<uint64, Player*> players;
+};
+
+#define sObjectAccessor ObjectAccessor::Instance()
+
+#endif
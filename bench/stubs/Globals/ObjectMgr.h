@@ -0,0 +1,158 @@
+#ifndef VOICEOVER_BENCH_STUB_OBJECTMGR_H
+#define VOICEOVER_BENCH_STUB_OBJECTMGR_H
+
+#include "StubCommon.h"
+#include "Entities/ObjectGuid.h"
+
+class Quest
+{
+public:
+    Quest() : QuestId(0), ZoneOrSort(0) {}
+
+    uint32 GetQuestId() const { return QuestId; }
+    int32 GetZoneOrSort() const { return ZoneOrSort; }
+    const std::string& GetTitle() const { return Title; }
+    const std::string& GetDetails() const { return Details; }
+    const std::string& GetObjectives() const { return Objectives; }
+    const std::string& GetRequestItemsText() const { return RequestItemsText; }
+    const std::string& GetOfferRewardText() const { return OfferRewardText; }
+
+    uint32 QuestId;
+    int32 ZoneOrSort;
+    std::string Title;
+    std::string Details;
+    std::string Objectives;
+    std::string RequestItemsText;
+    std::string OfferRewardText;
+};
+
+struct QuestLocale
+{
+    std::vector<std::string> Title;
+    std::vector<std::string> Details;
+    std::vector<std::string> Objectives;
+    std::vector<std::string> OfferRewardText;
+    std::vector<std::string> RequestItemsText;
+};
+
+struct CreatureLocale
+{
+    std::vector<std::string> Name;
+    std::vector<std::string> SubName;
+};
+
+struct GameObjectLocale
+{
+    std::vector<std::string> Name;
+};
+
+struct ItemLocale
+{
+    std::vector<std::string> Name;
+    std::vector<std::string> Description;
+};
+
+struct CreatureInfo
+{
+    uint32 Entry;
+    char* Name;
+};
+
+struct GameObjectInfo
+{
+    uint32 id;
+    char* name;
+};
+
+struct ItemPrototype
+{
+    uint32 ItemId;
+    char* Name1;
+    uint32 StartQuest;
+};
+
+typedef std::unordered_map<uint32, std::unique_ptr<Quest>> QuestMap;
+typedef std::multimap<uint32, uint32> QuestRelationsMap;
+typedef std::pair<QuestRelationsMap::const_iterator, QuestRelationsMap::const_iterator> QuestRelationsMapBounds;
+
+class ObjectMgr
+{
+public:
+    static ObjectMgr& Instance() { static ObjectMgr instance; return instance; }
+
+    const Quest* GetQuestTemplate(uint32 questId) const
+    {
+        auto itr = mQuestTemplates.find(questId);
+        return itr != mQuestTemplates.end() ? itr->second.get() : nullptr;
+    }
+    const QuestMap& GetQuestTemplates() const { return mQuestTemplates; }
+
+    const QuestLocale* GetQuestLocale(uint32 entry) const
+    {
+        auto itr = mQuestLocaleMap.find(entry);
+        return itr != mQuestLocaleMap.end() ? &itr->second : nullptr;
+    }
+
+    const CreatureLocale* GetCreatureLocale(uint32 entry) const
+    {
+        auto itr = mCreatureLocaleMap.find(entry);
+        return itr != mCreatureLocaleMap.end() ? &itr->second : nullptr;
+    }
+
+    void GetCreatureLocaleStrings(uint32 entry, int32 loc_idx, const char** namePtr, const char** subnamePtr = nullptr) const
+    {
+        if (loc_idx >= 0)
+        {
+            if (const CreatureLocale* il = GetCreatureLocale(entry))
+            {
+                if (namePtr && il->Name.size() > size_t(loc_idx) && !il->Name[loc_idx].empty())
+                    *namePtr = il->Name[loc_idx].c_str();
+
+                if (subnamePtr && il->SubName.size() > size_t(loc_idx) && !il->SubName[loc_idx].empty())
+                    *subnamePtr = il->SubName[loc_idx].c_str();
+            }
+        }
+    }
+
+    const GameObjectLocale* GetGameObjectLocale(uint32 entry) const
+    {
+        auto itr = mGameObjectLocaleMap.find(entry);
+        return itr != mGameObjectLocaleMap.end() ? &itr->second : nullptr;
+    }
+
+    const ItemLocale* GetItemLocale(uint32 entry) const
+    {
+        auto itr = mItemLocaleMap.find(entry);
+        return itr != mItemLocaleMap.end() ? &itr->second : nullptr;
+    }
+
+    static const CreatureInfo* GetCreatureTemplate(uint32 id);
+    static const GameObjectInfo* GetGameObjectInfo(uint32 id);
+    static const ItemPrototype* GetItemPrototype(uint32 id);
+
+    QuestRelationsMap& GetCreatureQuestRelationsMap() { return m_CreatureQuestRelations; }
+    QuestRelationsMap& GetCreatureQuestInvolvedRelationsMap() { return m_CreatureQuestInvolvedRelations; }
+    QuestRelationsMap& GetGOQuestRelationsMap() { return m_GOQuestRelations; }
+    QuestRelationsMap& GetGOQuestInvolvedRelationsMap() { return m_GOQuestInvolvedRelations; }
+
+    QuestRelationsMapBounds GetCreatureQuestRelationsMapBounds(uint32 entry) const { return m_CreatureQuestRelations.equal_range(entry); }
+    QuestRelationsMapBounds GetCreatureQuestInvolvedRelationsMapBounds(uint32 entry) const { return m_CreatureQuestInvolvedRelations.equal_range(entry); }
+    QuestRelationsMapBounds GetGOQuestRelationsMapBounds(uint32 entry) const { return m_GOQuestRelations.equal_range(entry); }
+    QuestRelationsMapBounds GetGOQuestInvolvedRelationsMapBounds(uint32 entry) const { return m_GOQuestInvolvedRelations.equal_range(entry); }
+
+public:
+    // Synthetic world storage, filled by the benchmark
+    QuestMap mQuestTemplates;
+    std::unordered_map<uint32, QuestLocale> mQuestLocaleMap;
+    std::unordered_map<uint32, CreatureLocale> mCreatureLocaleMap;
+    std::unordered_map<uint32, GameObjectLocale> mGameObjectLocaleMap;
+    std::unordered_map<uint32, ItemLocale> mItemLocaleMap;
+    QuestRelationsMap m_CreatureQuestRelations;
+    QuestRelationsMap m_CreatureQuestInvolvedRelations;
+    QuestRelationsMap m_GOQuestRelations;
+    QuestRelationsMap m_GOQuestInvolvedRelations;
+};
+
+#define sObjectMgr ObjectMgr::Instance()
+
+#endif
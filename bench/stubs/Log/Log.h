@@ -0,0 +1,32 @@
+#ifndef VOICEOVER_BENCH_STUB_LOG_H
+#define VOICEOVER_BENCH_STUB_LOG_H
+
+#include "StubCommon.h"
+
+class Log
+{
+public:
+    static Log& Instance() { static Log instance; return instance; }
+
+    void outString(const char* str, ...)
+    {
+        va_list ap;
+        va_start(ap, str);
+        std::vfprintf(stdout, str, ap);
+        va_end(ap);
+        std::fputc('\n', stdout);
+    }
+
+    void outError(const char* str, ...)
+    {
+        va_list ap;
+        va_start(ap, str);
+        std::vfprintf(stderr, str, ap);
+        va_end(ap);
+        std::fputc('\n', stderr);
+    }
+};
+
+#define sLog Log::Instance()
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef VOICEOVER_BENCH_STUB_MODULE_H
+#define VOICEOVER_BENCH_STUB_MODULE_H
+
+#include "ModuleConfig.h"
+#include "Chat/Chat.h"
+#include "Entities/Player.h"
+
+namespace cmangos_module
+{
+    namespace helper
+    {
+        inline std::vector<std::string> SplitString(const std::string& str, const std::string& delim)
+        {
+            std::vector<std::string> result;
+            size_t start = 0;
+            size_t end = str.find(delim);
+            while (end != std::string::npos)
+            {
+                result.push_back(str.substr(start, end - start));
+                start = end + delim.length();
+                end = str.find(delim, start);
+            }
+
+            result.push_back(str.substr(start));
+            return result;
+        }
+
+        inline bool IsValidNumberString(const std::string& str)
+        {
+            return !str.empty() && std::all_of(str.begin(), str.end(), ::isdigit);
+        }
+    }
+
+    struct ModuleChatCommand
+    {
+        ModuleChatCommand(const char* inName, std::function<bool(WorldSession*, const std::string&)> inHandler = nullptr, uint32 inSecurityLevel = SEC_CONSOLE)
+        : name(inName), handler(inHandler), securityLevel(inSecurityLevel) {}
+
+        const char* name;
+        std::function<bool(WorldSession*, const std::string&)> handler;
+        uint32 securityLevel;
+    };
+
+    class Module
+    {
+    public:
+        Module(const std::string& inName, ModuleConfig* inConfig) : name(inName), config(inConfig) {}
+        virtual ~Module() { delete config; }
+
+        const std::string& GetName() const { return name; }
+        virtual const ModuleConfig* GetConfig() const { return config; }
+        void LoadConfig() { config->Load(); }
+        ModuleConfig* GetMutableConfig() { return config; }
+
+        // Module Hooks
+        virtual void OnInitialize() {}
+        virtual void OnUpdate(uint32 elapsed) {}
+
+        // Player Hooks
+        virtual void OnCharacterCreated(Player* player) {}
+        virtual void OnCharacterDeleted(uint32 playerId) {}
+        virtual void OnPreLoadFromDB(Player* player) {}
+        virtual void OnLoadFromDB(Player* player) {}
+        virtual void OnSaveToDB(Player* player) {}
+        virtual void OnLogOut(Player* player) {}
+        virtual void OnUpdate(Player* player, uint32 diff) {}
+
+        // Commands
+        virtual std::vector<ModuleChatCommand>* GetCommandTable() { return nullptr; }
+        virtual const char* GetChatCommandPrefix() const { return nullptr; }
+
+    private:
+        std::string name;
+        ModuleConfig* config;
+    };
+}
+
+#endif
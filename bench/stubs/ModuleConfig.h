@@ -0,0 +1,57 @@
+#ifndef VOICEOVER_BENCH_STUB_MODULECONFIG_H
+#define VOICEOVER_BENCH_STUB_MODULECONFIG_H
+
+#include "StubCommon.h"
+
+// In-memory replacement for the core Config reader
+class Config
+{
+public:
+    void Set(const std::string& name, const std::string& value) { values[name] = value; }
+
+    std::string GetStringDefault(const char* name, const char* def = "") const
+    {
+        auto itr = values.find(name);
+        return itr != values.end() ? itr->second : std::string(def);
+    }
+
+    bool GetBoolDefault(const char* name, bool def = false) const
+    {
+        auto itr = values.find(name);
+        return itr != values.end() ? (itr->second == "1" || itr->second == "true") : def;
+    }
+
+    int32 GetIntDefault(const char* name, int32 def = 0) const
+    {
+        auto itr = values.find(name);
+        return itr != values.end() ? int32(std::stol(itr->second)) : def;
+    }
+
+    float GetFloatDefault(const char* name, float def = 0.0f) const
+    {
+        auto itr = values.find(name);
+        return itr != values.end() ? std::stof(itr->second) : def;
+    }
+
+private:
+    std::unordered_map<std::string, std::string> values;
+};
+
+namespace cmangos_module
+{
+    class ModuleConfig
+    {
+    public:
+        explicit ModuleConfig(const std::string& inFilename) : filename(inFilename) {}
+        virtual ~ModuleConfig() {}
+
+        bool Load() { return OnLoad(); }
+        virtual bool OnLoad() = 0;
+
+    public:
+        std::string filename;
+        Config config;
+    };
+}
+
+#endif
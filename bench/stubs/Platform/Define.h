@@ -0,0 +1,6 @@
+#ifndef VOICEOVER_BENCH_STUB_DEFINE_H
+#define VOICEOVER_BENCH_STUB_DEFINE_H
+
+#include "StubCommon.h"
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef VOICEOVER_BENCH_STUB_SQLSTORAGES_H
+#define VOICEOVER_BENCH_STUB_SQLSTORAGES_H
+
+#include "Globals/ObjectMgr.h"
+
+class SQLStorageBase
+{
+public:
+    template<class T>
+    class SQLSIterator
+    {
+    public:
+        explicit SQLSIterator(const T* ptr) : pointer(ptr) {}
+        const T* getValue() const { return pointer; }
+        void operator++() { ++pointer; }
+        const T* operator->() const { return pointer; }
+        bool operator<(const SQLSIterator& r) const { return pointer < r.pointer; }
+
+    private:
+        const T* pointer;
+    };
+};
+
+template<class T>
+class SQLStorageStub : public SQLStorageBase
+{
+public:
+    template<class U> SQLSIterator<U> getDataBegin() const { return SQLSIterator<U>(data.data()); }
+    template<class U> SQLSIterator<U> getDataEnd() const { return SQLSIterator<U>(data.data() + data.size()); }
+    template<class U> const U* LookupEntry(uint32 id) const
+    {
+        auto itr = index.find(id);
+        return itr != index.end() ? &data[itr->second] : nullptr;
+    }
+
+    void Add(const T& value, uint32 id) { index[id] = data.size(); data.push_back(value); }
+
+    std::vector<T> data;
+    std::unordered_map<uint32, size_t> index;
+};
+
+extern SQLStorageStub<CreatureInfo> sCreatureStorage;
+extern SQLStorageStub<GameObjectInfo> sGOStorage;
+extern SQLStorageStub<ItemPrototype> sItemStorage;
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef VOICEOVER_BENCH_STUB_WORLDPACKET_H
+#define VOICEOVER_BENCH_STUB_WORLDPACKET_H
+
+#include "StubCommon.h"
+
+enum Opcodes : uint16
+{
+    MSG_NULL_ACTION = 0x000,
+    SMSG_MESSAGECHAT = 0x096
+};
+
+class ByteBuffer
+{
+public:
+    ByteBuffer() : _rpos(0), _wpos(0) {}
+    explicit ByteBuffer(size_t reserved) : _rpos(0), _wpos(0) { _storage.reserve(reserved); }
+
+    void clear() { _storage.clear(); _rpos = _wpos = 0; }
+    void reserve(size_t ressize) { if (ressize > _storage.size()) _storage.reserve(ressize); }
+    size_t size() const { return _storage.size(); }
+    bool empty() const { return _storage.empty(); }
+    size_t wpos() const { return _wpos; }
+    const uint8* contents() const { return _storage.data(); }
+
+    void append(const uint8* src, size_t cnt)
+    {
+        if (!cnt)
+            return;
+
+        if (_storage.size() < _wpos + cnt)
+            _storage.resize(_wpos + cnt);
+
+        std::memcpy(&_storage[_wpos], src, cnt);
+        _wpos += cnt;
+    }
+
+    ByteBuffer& operator<<(uint8 value) { append(&value, sizeof(value)); return *this; }
+    ByteBuffer& operator<<(uint32 value) { append((const uint8*)&value, sizeof(value)); return *this; }
+    ByteBuffer& operator<<(uint64 value) { append((const uint8*)&value, sizeof(value)); return *this; }
+    ByteBuffer& operator<<(const char* str) { append((const uint8*)str, str ? std::strlen(str) : 0); return operator<<(uint8(0)); }
+
+protected:
+    size_t _rpos, _wpos;
+    std::vector<uint8> _storage;
+};
+
+class WorldPacket : public ByteBuffer
+{
+public:
+    WorldPacket() : ByteBuffer(0), m_opcode(MSG_NULL_ACTION) {}
+    explicit WorldPacket(uint16 opcode, size_t res = 200) : ByteBuffer(res), m_opcode(opcode) {}
+
+    void Initialize(uint16 opcode, size_t newres = 200)
+    {
+        clear();
+        _storage.reserve(newres);
+        m_opcode = opcode;
+    }
+
+    uint16 GetOpcode() const { return m_opcode; }
+
+private:
+    uint16 m_opcode;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef VOICEOVER_BENCH_STUB_WORLDSESSION_H
+#define VOICEOVER_BENCH_STUB_WORLDSESSION_H
+
+#include "Server/WorldPacket.h"
+
+class Player;
+
+// Packet-capturing session: every packet the module sends is counted
+// instead of being queued on a socket.
+class WorldSession
+{
+public:
+    WorldSession(uint32 accountId, int localeIndex)
+    : m_accountId(accountId), m_localeIndex(localeIndex), m_player(nullptr), m_latency(0), m_packets(0), m_bytes(0) {}
+
+    Player* GetPlayer() const { return m_player; }
+    void SetPlayer(Player* player) { m_player = player; }
+    uint32 GetAccountId() const { return m_accountId; }
+    int GetSessionDbLocaleIndex() const { return m_localeIndex; }
+    uint32 GetLatency() const { return m_latency; }
+    void SetLatency(uint32 latency) { m_latency = latency; }
+    AccountTypes GetSecurity() const { return SEC_ADMINISTRATOR; }
+
+    void SendPacket(const WorldPacket& packet, bool /*forcedSend*/ = false) const
+    {
+        ++m_packets;
+        m_bytes += packet.size();
+        if (m_capture)
+            m_capture(packet);
+    }
+
+    uint64 GetSentPackets() const { return m_packets; }
+    uint64 GetSentBytes() const { return m_bytes; }
+    void ResetCounters() { m_packets = 0; m_bytes = 0; }
+    void SetCapture(std::function<void(const WorldPacket&)> capture) { m_capture = std::move(capture); }
+
+private:
+    uint32 m_accountId;
+    int m_localeIndex;
+    Player* m_player;
+    uint32 m_latency;
+    mutable uint64 m_packets;
+    mutable uint64 m_bytes;
+    std::function<void(const WorldPacket&)> m_capture;
+};
+
+#endif
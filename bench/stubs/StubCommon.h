@@ -0,0 +1,65 @@
+#ifndef VOICEOVER_BENCH_STUB_COMMON_H
+#define VOICEOVER_BENCH_STUB_COMMON_H
+
+// Minimal stand-ins for the cmangos core types the voiceover module touches.
+// Only the members the module actually uses are provided.
+
+#include <cstdint>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef std::int8_t int8;
+typedef std::int16_t int16;
+typedef std::int32_t int32;
+typedef std::int64_t int64;
+typedef std::uint8_t uint8;
+typedef std::uint16_t uint16;
+typedef std::uint32_t uint32;
+typedef std::uint64_t uint64;
+
+#define MANGOS_ASSERT(x) do { if (!(x)) { std::fprintf(stderr, "assert: %s\n", #x); std::abort(); } } while (0)
+
+enum AccountTypes
+{
+    SEC_PLAYER = 0,
+    SEC_MODERATOR = 1,
+    SEC_GAMEMASTER = 2,
+    SEC_ADMINISTRATOR = 3,
+    SEC_CONSOLE = 4
+};
+
+enum LocaleConstant
+{
+    LOCALE_enUS = 0,
+    LOCALE_koKR = 1,
+    LOCALE_frFR = 2,
+    LOCALE_deDE = 3,
+    LOCALE_zhCN = 4,
+    LOCALE_zhTW = 5,
+    LOCALE_esES = 6,
+    LOCALE_esMX = 7,
+    LOCALE_ruRU = 8
+};
+
+#define MAX_LOCALE 9
+
+inline char* mangos_strdup(const char* source)
+{
+    char* dest = new char[std::strlen(source) + 1];
+    std::strcpy(dest, source);
+    return dest;
+}
+
+enum TimeConstants { MINUTE = 60, HOUR = MINUTE * 60, DAY = HOUR * 24, IN_MILLISECONDS = 1000 };
+
+#endif
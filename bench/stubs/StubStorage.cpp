@@ -0,0 +1,9 @@
+#include "Server/SQLStorages.h"
+
+SQLStorageStub<CreatureInfo> sCreatureStorage;
+SQLStorageStub<GameObjectInfo> sGOStorage;
+SQLStorageStub<ItemPrototype> sItemStorage;
+
+const CreatureInfo* ObjectMgr::GetCreatureTemplate(uint32 id) { return sCreatureStorage.LookupEntry<CreatureInfo>(id); }
+const GameObjectInfo* ObjectMgr::GetGameObjectInfo(uint32 id) { return sGOStorage.LookupEntry<GameObjectInfo>(id); }
+const ItemPrototype* ObjectMgr::GetItemPrototype(uint32 id) { return sItemStorage.LookupEntry<ItemPrototype>(id); }
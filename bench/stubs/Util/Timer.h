@@ -0,0 +1,23 @@
+#ifndef VOICEOVER_BENCH_STUB_TIMER_H
+#define VOICEOVER_BENCH_STUB_TIMER_H
+
+#include "StubCommon.h"
+#include <chrono>
+
+class WorldTimer
+{
+public:
+    static uint32 getMSTime()
+    {
+        using namespace std::chrono;
+        static const steady_clock::time_point start = steady_clock::now();
+        return uint32(duration_cast<milliseconds>(steady_clock::now() - start).count());
+    }
+
+    static uint32 getMSTimeDiff(uint32 oldMSTime, uint32 newMSTime)
+    {
+        return newMSTime - oldMSTime;
+    }
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef VOICEOVER_BENCH_STUB_WORLD_H
+#define VOICEOVER_BENCH_STUB_WORLD_H
+
+#include "StubCommon.h"
+
+enum eConfigFloatValues
+{
+    CONFIG_FLOAT_LISTEN_RANGE_SAY,
+    CONFIG_FLOAT_LISTEN_RANGE_YELL,
+    CONFIG_FLOAT_VALUE_COUNT
+};
+
+class World
+{
+public:
+    static World& Instance() { static World instance; return instance; }
+
+    // The defaults of the core config
+    World() : m_configFloatValues{ 40.0f, 300.0f } {}
+
+    float getConfig(eConfigFloatValues index) const { return m_configFloatValues[index]; }
+    void setConfig(eConfigFloatValues index, float value) { m_configFloatValues[index] = value; }
+
+private:
+    float m_configFloatValues[CONFIG_FLOAT_VALUE_COUNT];
+};
+
+#define sWorld World::Instance()
+
+#endif
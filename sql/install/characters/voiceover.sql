@@ -0,0 +1,7 @@
+DROP TABLE IF EXISTS `custom_voiceover_character`;
+CREATE TABLE `custom_voiceover_character` (
+  `guid` int(11) unsigned NOT NULL COMMENT 'Character guid',
+  `capabilities` int(11) unsigned NOT NULL DEFAULT '0' COMMENT 'Protocol features requested by the addon',
+  `quest_log_hash` int(11) unsigned NOT NULL DEFAULT '0' COMMENT 'Hash of the quest log the addon was last kept in sync with',
+  PRIMARY KEY (`guid`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8 COMMENT='VoiceOver addon state per character';
@@ -0,0 +1,87 @@
+#include "VoiceoverAddonCommand.h"
+
+#include <charconv>
+
+namespace cmangos_module
+{
+    bool ParseAddonNumber(std::string_view str, uint32& value)
+    {
+        // from_chars takes neither signs nor spaces, so the whole string has to be digits
+        const char* end = str.data() + str.size();
+        const std::from_chars_result result = std::from_chars(str.data(), end, value);
+        if (str.empty() || result.ec != std::errc() || result.ptr != end)
+        {
+            value = 0;
+            return false;
+        }
+
+        return true;
+    }
+
+    AddonCommand ParseAddonRequest(std::string_view request, std::string_view& args)
+    {
+        const size_t nameEnd = request.find(' ');
+        args = nameEnd != std::string_view::npos ? request.substr(nameEnd + 1) : std::string_view();
+        return GetAddonCommand(request.substr(0, nameEnd));
+    }
+
+    EnableAddonArgs ParseEnableAddonArgs(std::string_view args)
+    {
+        std::string_view fields[3];
+        for (std::string_view& field : fields)
+        {
+            const size_t fieldEnd = args.find(' ');
+            field = args.substr(0, fieldEnd);
+            if (fieldEnd == std::string_view::npos)
+            {
+                break;
+            }
+
+            args.remove_prefix(fieldEnd + 1);
+        }
+
+        EnableAddonArgs result;
+        ParseAddonNumber(fields[0], result.capabilities);
+        result.hasQuestLogHash = ParseAddonNumber(fields[1], result.questLogHash);
+        result.hasQuestLogSequence = ParseAddonNumber(fields[2], result.questLogSequence);
+        return result;
+    }
+
+    QuestLogArgs ParseQuestLogArgs(std::string_view args)
+    {
+        QuestLogArgs result;
+        result.hasSequence = ParseAddonNumber(args, result.sinceSequence);
+        return result;
+    }
+
+    bool ParseSoundEventArgs(std::string_view args, SoundEventArgs& result)
+    {
+        const size_t eventEnd = args.find(';');
+        const size_t idEnd = eventEnd != std::string_view::npos ? args.find(';', eventEnd + 1) : std::string_view::npos;
+        if (idEnd == std::string_view::npos)
+        {
+            return false;
+        }
+
+        uint32 eventType;
+        result.eventType = ParseAddonNumber(args.substr(0, eventEnd), eventType) && eventType <= 0xFF ? (uint8)eventType : 0;
+        ParseAddonNumber(args.substr(eventEnd + 1, idEnd - eventEnd - 1), result.id);
+
+        result.text = args.substr(idEnd + 1);
+        return true;
+    }
+
+    QuestTitleArgs ParseQuestTitleArgs(std::string_view text)
+    {
+        QuestTitleArgs result;
+        const size_t fingerprintEnd = text.find(';');
+        if (fingerprintEnd != std::string_view::npos)
+        {
+            result.fingerprint = text.substr(0, fingerprintEnd);
+            text.remove_prefix(fingerprintEnd + 1);
+        }
+
+        result.title = text;
+        return result;
+    }
+}
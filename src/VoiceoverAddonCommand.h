@@ -0,0 +1,90 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_ADDON_COMMAND_H
+#define CMANGOS_MODULE_VOICEOVER_ADDON_COMMAND_H
+
+#include "Platform/Define.h"
+
+#include <string_view>
+
+namespace cmangos_module
+{
+    // Requests the addon sends to the server, the values are stored in the trace files
+    enum class AddonCommand : uint8
+    {
+        NONE = 0,
+        ENABLE_ADDON = 1,
+        QUEST_LOG = 2,
+        SOUND_EVENT = 3,
+        MAX
+    };
+
+    // Names the addon sends the commands with, indexed by command
+    constexpr std::string_view ADDON_COMMAND_NAMES[(uint8)AddonCommand::MAX] = { "", "enableAddon", "questLog", "soundEvent" };
+
+    constexpr AddonCommand GetAddonCommand(std::string_view name)
+    {
+        for (uint8 i = 1; i < (uint8)AddonCommand::MAX; ++i)
+        {
+            if (ADDON_COMMAND_NAMES[i] == name)
+            {
+                return (AddonCommand)i;
+            }
+        }
+
+        return AddonCommand::NONE;
+    }
+
+    constexpr std::string_view GetAddonCommandName(AddonCommand command)
+    {
+        return command < AddonCommand::MAX ? ADDON_COMMAND_NAMES[(uint8)command] : std::string_view();
+    }
+
+    // "capabilities questLogHash questLogSequence", older addons send less or nothing
+    struct EnableAddonArgs
+    {
+        uint32 capabilities = 0;
+        bool hasQuestLogHash = false;
+        uint32 questLogHash = 0;
+        bool hasQuestLogSequence = false;
+        uint32 questLogSequence = 0;
+    };
+
+    // "sequence" to only get the quest log changes after it, nothing for the whole quest log
+    struct QuestLogArgs
+    {
+        bool hasSequence = false;
+        uint32 sinceSequence = 0;
+    };
+
+    // "eventType;id;text", the text is the rest of the line as gossip texts can contain ';'
+    struct SoundEventArgs
+    {
+        uint8 eventType = 0;
+        uint32 id = 0;
+        std::string_view text;
+    };
+
+    // "fingerprint;title", the text of the quest sound events of addons that send the fingerprint of the
+    // quest frame text. The fingerprint is empty when the addon knows the quest id.
+    struct QuestTitleArgs
+    {
+        std::string_view fingerprint;
+        std::string_view title;
+    };
+
+    // The parsers don't copy anything, the views they return point into the given string.
+    // Numbers must be plain decimals that fit in 32 bits, anything else counts as missing (0).
+    bool ParseAddonNumber(std::string_view str, uint32& value);
+
+    // Splits "command args" as sent over the addon channel
+    AddonCommand ParseAddonRequest(std::string_view request, std::string_view& args);
+
+    EnableAddonArgs ParseEnableAddonArgs(std::string_view args);
+    QuestLogArgs ParseQuestLogArgs(std::string_view args);
+
+    // False if the args don't have the three fields, an event type or id that isn't a number is left as 0
+    bool ParseSoundEventArgs(std::string_view args, SoundEventArgs& result);
+
+    // Takes the text of the sound event args, a text without fingerprint is all title
+    QuestTitleArgs ParseQuestTitleArgs(std::string_view text);
+}
+#endif
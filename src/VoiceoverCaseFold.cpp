@@ -0,0 +1,268 @@
+#include "VoiceoverCaseFold.h"
+
+#include <array>
+#include <cstring>
+
+namespace cmangos_module
+{
+    // The table covers ASCII up to the end of the Cyrillic block
+    constexpr uint32 FOLD_TABLE_SIZE = 0x500;
+
+    // Bytes that aren't part of a valid UTF-8 sequence decode past the last Unicode code point
+    constexpr uint32 INVALID_BYTE_CODE_POINT = 0x110000;
+
+    constexpr uint64 CHUNK_ONES = 0x0101010101010101ull;
+    constexpr uint64 CHUNK_HIGH_BITS = 0x8080808080808080ull;
+
+    constexpr uint32 FNV_PRIME = 16777619u;
+
+    typedef std::array<uint16, FOLD_TABLE_SIZE> FoldTable;
+
+    constexpr void FoldRange(FoldTable& table, uint32 first, uint32 last, uint32 offset)
+    {
+        for (uint32 c = first; c <= last; ++c)
+        {
+            table[c] = (uint16)(c + offset);
+        }
+    }
+
+    // Blocks where every uppercase letter is directly followed by its lowercase one
+    constexpr void FoldPairs(FoldTable& table, uint32 first, uint32 last)
+    {
+        for (uint32 c = first; c < last; c += 2)
+        {
+            table[c] = (uint16)(c + 1);
+        }
+    }
+
+    constexpr FoldTable MakeFoldTable()
+    {
+        FoldTable table = {};
+        for (uint32 c = 0; c < FOLD_TABLE_SIZE; ++c)
+        {
+            table[c] = (uint16)c;
+        }
+
+        FoldRange(table, 'A', 'Z', 0x20);
+
+        // Latin-1, without the multiplication sign
+        FoldRange(table, 0x00C0, 0x00D6, 0x20);
+        FoldRange(table, 0x00D8, 0x00DE, 0x20);
+
+        // Latin Extended-A. The dotted I and the long s fold to ASCII letters, they are left out to
+        // keep the folds the same length.
+        FoldPairs(table, 0x0100, 0x012F);
+        FoldPairs(table, 0x0132, 0x0137);
+        FoldPairs(table, 0x0139, 0x0148);
+        FoldPairs(table, 0x014A, 0x0177);
+        table[0x0178] = 0x00FF;
+        FoldPairs(table, 0x0179, 0x017E);
+
+        // Greek, the final sigma folds to the other one
+        table[0x0386] = 0x03AC;
+        FoldRange(table, 0x0388, 0x038A, 0x25);
+        table[0x038C] = 0x03CC;
+        FoldRange(table, 0x038E, 0x038F, 0x3F);
+        FoldRange(table, 0x0391, 0x03A1, 0x20);
+        FoldRange(table, 0x03A3, 0x03AB, 0x20);
+        table[0x03C2] = 0x03C3;
+
+        // Cyrillic
+        FoldRange(table, 0x0400, 0x040F, 0x50);
+        FoldRange(table, 0x0410, 0x042F, 0x20);
+        FoldPairs(table, 0x0460, 0x0481);
+        FoldPairs(table, 0x048A, 0x04BF);
+        table[0x04C0] = 0x04CF;
+        FoldPairs(table, 0x04C1, 0x04CE);
+        FoldPairs(table, 0x04D0, 0x04FF);
+
+        return table;
+    }
+
+    constexpr FoldTable foldTable = MakeFoldTable();
+
+    uint64 LoadChunk(const char* text)
+    {
+        uint64 chunk;
+        memcpy(&chunk, text, sizeof(chunk));
+        return chunk;
+    }
+
+    // Lowercases 8 ASCII bytes at once. No byte has its high bit set, so the additions never carry
+    // into the next byte and their high bits tell which bytes are from 'A' to 'Z'.
+    uint64 FoldAsciiChunk(uint64 chunk)
+    {
+        const uint64 fromA = chunk + CHUNK_ONES * (0x80 - 'A');
+        const uint64 pastZ = chunk + CHUNK_ONES * (0x80 - 'Z' - 1);
+        return chunk | ((fromA & ~pastZ & CHUNK_HIGH_BITS) >> 2);
+    }
+
+    // Returns the length of the character at the start of the text
+    size_t DecodeCodePoint(const unsigned char* text, size_t size, uint32& codePoint)
+    {
+        const unsigned char lead = text[0];
+        if (lead < 0x80)
+        {
+            codePoint = lead;
+            return 1;
+        }
+
+        size_t length = 0;
+        uint32 value = 0;
+        uint32 minValue = 0;
+        if ((lead & 0xE0) == 0xC0)
+        {
+            length = 2;
+            value = lead & 0x1F;
+            minValue = 0x80;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            length = 3;
+            value = lead & 0x0F;
+            minValue = 0x800;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            length = 4;
+            value = lead & 0x07;
+            minValue = 0x10000;
+        }
+
+        if (length == 0 || length > size)
+        {
+            codePoint = INVALID_BYTE_CODE_POINT + lead;
+            return 1;
+        }
+
+        for (size_t i = 1; i < length; ++i)
+        {
+            if ((text[i] & 0xC0) != 0x80)
+            {
+                codePoint = INVALID_BYTE_CODE_POINT + lead;
+                return 1;
+            }
+
+            value = (value << 6) | (text[i] & 0x3F);
+        }
+
+        // Overlong sequences would otherwise match the shorter ones
+        if (value < minValue || value >= INVALID_BYTE_CODE_POINT)
+        {
+            codePoint = INVALID_BYTE_CODE_POINT + lead;
+            return 1;
+        }
+
+        codePoint = value;
+        return length;
+    }
+
+    uint32 HashBytes(uint32 hash, const unsigned char* bytes, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+
+        return hash;
+    }
+
+    uint32 FoldCodePoint(uint32 codePoint)
+    {
+        return codePoint < FOLD_TABLE_SIZE ? foldTable[codePoint] : codePoint;
+    }
+
+    uint32 HashFoldedText(std::string_view text, uint32 seed)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+        const size_t size = text.size();
+
+        uint32 hash = seed;
+        size_t pos = 0;
+        while (pos < size)
+        {
+            if (size - pos >= sizeof(uint64))
+            {
+                const uint64 chunk = LoadChunk(text.data() + pos);
+                if ((chunk & CHUNK_HIGH_BITS) == 0)
+                {
+                    unsigned char folded[sizeof(uint64)];
+                    const uint64 foldedChunk = FoldAsciiChunk(chunk);
+                    memcpy(folded, &foldedChunk, sizeof(folded));
+                    hash = HashBytes(hash, folded, sizeof(folded));
+                    pos += sizeof(uint64);
+                    continue;
+                }
+            }
+
+            uint32 codePoint;
+            const size_t length = DecodeCodePoint(bytes + pos, size - pos, codePoint);
+            const uint32 folded = FoldCodePoint(codePoint);
+            if (folded == codePoint)
+            {
+                hash = HashBytes(hash, bytes + pos, length);
+            }
+            else if (folded < 0x80)
+            {
+                const unsigned char encoded = (unsigned char)folded;
+                hash = HashBytes(hash, &encoded, 1);
+            }
+            else
+            {
+                // Every other fold is between two byte characters
+                const unsigned char encoded[2] = { (unsigned char)(0xC0 | (folded >> 6)), (unsigned char)(0x80 | (folded & 0x3F)) };
+                hash = HashBytes(hash, encoded, 2);
+            }
+
+            pos += length;
+        }
+
+        return hash;
+    }
+
+    bool IsSameFoldedText(std::string_view a, std::string_view b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+
+        const unsigned char* bytesA = reinterpret_cast<const unsigned char*>(a.data());
+        const unsigned char* bytesB = reinterpret_cast<const unsigned char*>(b.data());
+        const size_t size = a.size();
+
+        // Equal texts stay at the same offsets as every fold keeps the length of the character
+        size_t pos = 0;
+        while (pos < size)
+        {
+            if (size - pos >= sizeof(uint64))
+            {
+                const uint64 chunkA = LoadChunk(a.data() + pos);
+                const uint64 chunkB = LoadChunk(b.data() + pos);
+                if (((chunkA | chunkB) & CHUNK_HIGH_BITS) == 0)
+                {
+                    if (chunkA != chunkB && FoldAsciiChunk(chunkA) != FoldAsciiChunk(chunkB))
+                    {
+                        return false;
+                    }
+
+                    pos += sizeof(uint64);
+                    continue;
+                }
+            }
+
+            uint32 codePointA;
+            uint32 codePointB;
+            const size_t length = DecodeCodePoint(bytesA + pos, size - pos, codePointA);
+            if (DecodeCodePoint(bytesB + pos, size - pos, codePointB) != length || FoldCodePoint(codePointA) != FoldCodePoint(codePointB))
+            {
+                return false;
+            }
+
+            pos += length;
+        }
+
+        return true;
+    }
+}
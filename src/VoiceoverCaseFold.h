@@ -0,0 +1,25 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_CASE_FOLD_H
+#define CMANGOS_MODULE_VOICEOVER_CASE_FOLD_H
+
+#include "Platform/Define.h"
+
+#include <string_view>
+
+namespace cmangos_module
+{
+    // Case insensitive comparison and hashing of UTF-8 texts such as the localized quest titles, done in
+    // place without lowercased copies. Runs of ASCII are folded 8 bytes at a time, other characters
+    // through a table of the Latin-1, Latin Extended-A, Greek and Cyrillic letters used by the game's
+    // locales. Every fold keeps the UTF-8 length of the character, so texts of different lengths never
+    // match. Bytes that aren't valid UTF-8 only match themselves.
+
+    // Lowercase of the code point, itself if it has none the table knows of
+    uint32 FoldCodePoint(uint32 codePoint);
+
+    // 32 bit FNV-1a over the folded text, the same as over its bytes for texts without uppercase letters.
+    // Another seed gives a second hash to check the texts whose first hash is the same.
+    uint32 HashFoldedText(std::string_view text, uint32 seed = 2166136261u);
+
+    bool IsSameFoldedText(std::string_view a, std::string_view b);
+}
+#endif
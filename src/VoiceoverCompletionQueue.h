@@ -0,0 +1,82 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_COMPLETION_QUEUE_H
+#define CMANGOS_MODULE_VOICEOVER_COMPLETION_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace cmangos_module
+{
+    // Lock-free queue that any number of threads push to and a single thread drains.
+    // Pushing links a node in front of the head with a CAS, draining takes the whole
+    // list with one exchange and walks it oldest first.
+    template<class T>
+    class VoiceoverCompletionQueue
+    {
+        struct Node
+        {
+            explicit Node(T&& inValue) : value(std::move(inValue)), next(nullptr) {}
+
+            T value;
+            Node* next;
+        };
+
+    public:
+        VoiceoverCompletionQueue() : head(nullptr), size(0) {}
+        VoiceoverCompletionQueue(const VoiceoverCompletionQueue&) = delete;
+        VoiceoverCompletionQueue& operator=(const VoiceoverCompletionQueue&) = delete;
+
+        ~VoiceoverCompletionQueue()
+        {
+            Drain([](T&) {});
+        }
+
+        void Push(T&& value)
+        {
+            Node* node = new Node(std::move(value));
+            node->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+            size.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Must only be called from one thread at a time
+        template<class Visitor>
+        size_t Drain(Visitor&& visitor)
+        {
+            Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+            // The list is newest first, reverse it to keep the push order
+            Node* oldest = nullptr;
+            while (node)
+            {
+                Node* next = node->next;
+                node->next = oldest;
+                oldest = node;
+                node = next;
+            }
+
+            size_t count = 0;
+            while (oldest)
+            {
+                Node* next = oldest->next;
+                visitor(oldest->value);
+                delete oldest;
+                oldest = next;
+                count++;
+            }
+
+            size.fetch_sub(count, std::memory_order_relaxed);
+            return count;
+        }
+
+        bool IsEmpty() const { return head.load(std::memory_order_relaxed) == nullptr; }
+
+        // Approximate while other threads push, only meant for monitoring
+        size_t GetSize() const { return size.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<Node*> head;
+        std::atomic<size_t> size;
+    };
+}
+#endif
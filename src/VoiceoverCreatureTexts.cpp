@@ -0,0 +1,70 @@
+#include "VoiceoverCreatureTexts.h"
+
+#include <algorithm>
+
+namespace cmangos_module
+{
+    void VoiceoverCreatureTexts::AddListener(const ObjectGuid& player, uint64 mapKey)
+    {
+        std::lock_guard<std::mutex> lock(listenersMutex);
+        auto mapIt = listenerMaps.find(player.GetRawValue());
+        if (mapIt != listenerMaps.end())
+        {
+            if (mapIt->second == mapKey)
+            {
+                return;
+            }
+
+            std::vector<ObjectGuid>& oldListeners = mapListeners[mapIt->second];
+            oldListeners.erase(std::find(oldListeners.begin(), oldListeners.end(), player));
+            if (oldListeners.empty())
+            {
+                mapListeners.erase(mapIt->second);
+            }
+
+            mapIt->second = mapKey;
+        }
+        else
+        {
+            listenerMaps.emplace(player.GetRawValue(), mapKey);
+        }
+
+        mapListeners[mapKey].push_back(player);
+    }
+
+    void VoiceoverCreatureTexts::RemoveListener(const ObjectGuid& player)
+    {
+        std::lock_guard<std::mutex> lock(listenersMutex);
+        auto mapIt = listenerMaps.find(player.GetRawValue());
+        if (mapIt != listenerMaps.end())
+        {
+            std::vector<ObjectGuid>& listeners = mapListeners[mapIt->second];
+            listeners.erase(std::find(listeners.begin(), listeners.end(), player));
+            if (listeners.empty())
+            {
+                mapListeners.erase(mapIt->second);
+            }
+
+            listenerMaps.erase(mapIt);
+        }
+    }
+
+    bool VoiceoverCreatureTexts::HasListeners(uint64 mapKey) const
+    {
+        std::lock_guard<std::mutex> lock(listenersMutex);
+        return mapListeners.find(mapKey) != mapListeners.end();
+    }
+
+    void VoiceoverCreatureTexts::Push(CreatureText&& text)
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingTexts.push_back(std::move(text));
+    }
+
+    void VoiceoverCreatureTexts::TakePending(std::vector<CreatureText>& texts)
+    {
+        texts.clear();
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingTexts.swap(texts);
+    }
+}
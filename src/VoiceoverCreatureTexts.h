@@ -0,0 +1,78 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_CREATURE_TEXTS_H
+#define CMANGOS_MODULE_VOICEOVER_CREATURE_TEXTS_H
+
+#include "Entities/ObjectGuid.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cmangos_module
+{
+    // A say or yell line of a creature, with where it was said from
+    struct CreatureText
+    {
+        ObjectGuid source;
+        uint64 mapKey = 0;
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float range = 0.0f;
+        std::string text;
+
+        bool IsInRange(float targetX, float targetY, float targetZ) const
+        {
+            const float dx = x - targetX;
+            const float dy = y - targetY;
+            const float dz = z - targetZ;
+            return dx * dx + dy * dy + dz * dz <= range * range;
+        }
+    };
+
+    // The players listening for creature texts grouped by the map instance they are in, and the
+    // lines creatures said since the last world update. A line only has to be checked against
+    // the listeners of its map, and the lines of a map nobody listens on aren't kept at all.
+    // Every method can be called from any thread.
+    class VoiceoverCreatureTexts
+    {
+    public:
+        static uint64 MakeMapKey(uint32 mapId, uint32 instanceId) { return ((uint64)mapId << 32) | instanceId; }
+
+        // Adds the player to the listeners of the map, or moves it there from the map it was in
+        void AddListener(const ObjectGuid& player, uint64 mapKey);
+        void RemoveListener(const ObjectGuid& player);
+        bool HasListeners(uint64 mapKey) const;
+
+        // Calls visitor(guid) for every listener of the map, listeners can't be added or removed meanwhile
+        template<class Visitor>
+        void VisitListeners(uint64 mapKey, Visitor&& visitor) const;
+
+        void Push(CreatureText&& text);
+        // Swaps the lines said since the last call into the given vector
+        void TakePending(std::vector<CreatureText>& texts);
+
+    private:
+        mutable std::mutex listenersMutex;
+        std::unordered_map<uint64, std::vector<ObjectGuid>> mapListeners;
+        std::unordered_map<uint64, uint64> listenerMaps;
+
+        std::mutex pendingMutex;
+        std::vector<CreatureText> pendingTexts;
+    };
+
+    template<class Visitor>
+    void VoiceoverCreatureTexts::VisitListeners(uint64 mapKey, Visitor&& visitor) const
+    {
+        std::lock_guard<std::mutex> lock(listenersMutex);
+        auto listenersIt = mapListeners.find(mapKey);
+        if (listenersIt != mapListeners.end())
+        {
+            for (const ObjectGuid& listener : listenersIt->second)
+            {
+                visitor(listener);
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,210 @@
+#include "VoiceoverGossipIndex.h"
+
+#include "Log/Log.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace cmangos_module
+{
+    bool VoiceoverGossipIndex::Load(const std::string& fileName)
+    {
+        Clear();
+
+        std::ifstream file(fileName);
+        if (!file.is_open())
+        {
+            sLog.outError("Voiceover: can't open gossip lookup file %s", fileName.c_str());
+            return false;
+        }
+
+        // Every line is "type\tentry\thash\ttext", lines starting with # are comments
+        uint32 invalidLines = 0;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+
+            const size_t typeEnd = line.find('\t');
+            const size_t entryEnd = typeEnd != std::string::npos ? line.find('\t', typeEnd + 1) : std::string::npos;
+            const size_t hashEnd = entryEnd != std::string::npos ? line.find('\t', entryEnd + 1) : std::string::npos;
+            if (hashEnd == std::string::npos)
+            {
+                invalidLines++;
+                continue;
+            }
+
+            const std::string type = line.substr(0, typeEnd);
+            const QuestStarterType giverType = type == "npc" ? QuestStarterType::CREATURE : type == "object" ? QuestStarterType::GAMEOBJECT : QuestStarterType::NONE;
+            const uint32 giverEntry = (uint32)strtoul(line.c_str() + typeEnd + 1, nullptr, 10);
+            const std::string hash = line.substr(entryEnd + 1, hashEnd - entryEnd - 1);
+            if (giverType == QuestStarterType::NONE || giverEntry == 0 || hash.empty())
+            {
+                invalidLines++;
+                continue;
+            }
+
+            AddGossipText(giverType, giverEntry, line.substr(hashEnd + 1), hash);
+        }
+
+        std::sort(textHashes.begin(), textHashes.end());
+        std::sort(tokenPostings.begin(), tokenPostings.end());
+        textHashes.shrink_to_fit();
+        tokenPostings.shrink_to_fit();
+        gossipTexts.shrink_to_fit();
+
+        if (invalidLines > 0)
+        {
+            sLog.outError("Voiceover: skipped %u invalid lines in gossip lookup file %s", invalidLines, fileName.c_str());
+        }
+
+        sLog.outString(">> Voiceover: indexed %u gossip texts (%u words)", (uint32)gossipTexts.size(), (uint32)tokenPostings.size());
+        return true;
+    }
+
+    void VoiceoverGossipIndex::Clear()
+    {
+        gossipTexts.clear();
+        textHashes.clear();
+        tokenPostings.clear();
+    }
+
+    const std::string* VoiceoverGossipIndex::GetGossipHash(QuestStarterType giverType, uint32 giverEntry, const std::string& text) const
+    {
+        if (gossipTexts.empty() || text.empty())
+        {
+            return nullptr;
+        }
+
+        std::vector<uint32> tokenHashes;
+        const uint32 textHash = Tokenize(text, tokenHashes);
+
+        // Texts sent as they were exported only need a single lookup
+        const uint64 textKey = MakeGossipKey(giverType, giverEntry, textHash);
+        auto textIt = std::lower_bound(textHashes.begin(), textHashes.end(), GossipKey{ textKey, 0 });
+        if (textIt != textHashes.end() && textIt->key == textKey)
+        {
+            return &gossipTexts[textIt->textIndex].hash;
+        }
+
+        // Otherwise count the words each of the giver texts shares with the given one.
+        // A giver only has a handful of texts so a flat list is enough to hold them.
+        std::vector<std::pair<uint32, uint32>> sharedTokens;
+        for (const uint32 tokenHash : tokenHashes)
+        {
+            const uint64 tokenKey = MakeGossipKey(giverType, giverEntry, tokenHash);
+            for (auto postingIt = std::lower_bound(tokenPostings.begin(), tokenPostings.end(), GossipKey{ tokenKey, 0 }); postingIt != tokenPostings.end() && postingIt->key == tokenKey; ++postingIt)
+            {
+                auto sharedIt = std::find_if(sharedTokens.begin(), sharedTokens.end(), [postingIt](const std::pair<uint32, uint32>& shared)
+                {
+                    return shared.first == postingIt->textIndex;
+                });
+
+                if (sharedIt != sharedTokens.end())
+                {
+                    sharedIt->second++;
+                }
+                else
+                {
+                    sharedTokens.emplace_back(postingIt->textIndex, 1);
+                }
+            }
+        }
+
+        // Same Jaccard similarity the addon uses (shared words / all distinct words),
+        // compared as cross products to stay in integers
+        const std::string* bestHash = nullptr;
+        uint64 bestShared = 0;
+        uint64 bestUnion = 1;
+        for (const auto& [textIndex, shared] : sharedTokens)
+        {
+            const GossipText& gossipText = gossipTexts[textIndex];
+            const uint64 totalTokens = (uint64)tokenHashes.size() + gossipText.tokenCount - shared;
+            if ((uint64)shared * bestUnion > bestShared * totalTokens)
+            {
+                bestHash = &gossipText.hash;
+                bestShared = shared;
+                bestUnion = totalTokens;
+            }
+        }
+
+        return bestHash;
+    }
+
+    void VoiceoverGossipIndex::AddGossipText(QuestStarterType giverType, uint32 giverEntry, const std::string& text, const std::string& hash)
+    {
+        std::vector<uint32> tokenHashes;
+        const uint32 textHash = Tokenize(text, tokenHashes);
+        if (tokenHashes.empty())
+        {
+            return;
+        }
+
+        const uint32 textIndex = (uint32)gossipTexts.size();
+        gossipTexts.push_back({ hash, (uint32)tokenHashes.size() });
+
+        textHashes.push_back({ MakeGossipKey(giverType, giverEntry, textHash), textIndex });
+        for (const uint32 tokenHash : tokenHashes)
+        {
+            tokenPostings.push_back({ MakeGossipKey(giverType, giverEntry, tokenHash), textIndex });
+        }
+    }
+
+    uint32 VoiceoverGossipIndex::Tokenize(const std::string& text, std::vector<uint32>& tokenHashes)
+    {
+        // Words are split on whitespace like the addon does, the text hash is
+        // taken over the words joined by single spaces
+        std::string normalizedText;
+        normalizedText.reserve(text.size());
+
+        const auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            while (pos < text.size() && isSpace(text[pos]))
+            {
+                pos++;
+            }
+
+            const size_t tokenStart = pos;
+            while (pos < text.size() && !isSpace(text[pos]))
+            {
+                pos++;
+            }
+
+            if (pos > tokenStart)
+            {
+                tokenHashes.push_back(VoiceoverQuestIndex::HashTitle(text.data() + tokenStart, pos - tokenStart));
+
+                if (!normalizedText.empty())
+                {
+                    normalizedText.push_back(' ');
+                }
+
+                normalizedText.append(text, tokenStart, pos - tokenStart);
+            }
+        }
+
+        // Repeated words only count once
+        std::sort(tokenHashes.begin(), tokenHashes.end());
+        tokenHashes.erase(std::unique(tokenHashes.begin(), tokenHashes.end()), tokenHashes.end());
+
+        return VoiceoverQuestIndex::HashTitle(normalizedText);
+    }
+
+    uint64 VoiceoverGossipIndex::MakeGossipKey(QuestStarterType giverType, uint32 giverEntry, uint32 hash)
+    {
+        // [giver type:2][giver entry:24][text or word hash:32]
+        return ((uint64)((uint8)giverType & 0x3) << 56) |
+               ((uint64)(giverEntry & 0xFFFFFF) << 32) |
+               (uint64)hash;
+    }
+}
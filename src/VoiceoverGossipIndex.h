@@ -0,0 +1,52 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_GOSSIP_INDEX_H
+#define CMANGOS_MODULE_VOICEOVER_GOSSIP_INDEX_H
+
+#include "VoiceoverQuestIndex.h"
+
+#include <vector>
+
+namespace cmangos_module
+{
+    // Gossip and greeting texts of the voiced npcs and gameobjects, loaded from the
+    // lookup table exported from the addon data modules (see tools/export_gossip_lookup.py).
+    // Texts are matched by their normalized hash first and by shared words otherwise,
+    // through an inverted index of the words each giver uses.
+    class VoiceoverGossipIndex
+    {
+    public:
+        bool Load(const std::string& fileName);
+        void Clear();
+
+        // Returns the sound hash of the giver text that best matches the given text, or nullptr if none does
+        const std::string* GetGossipHash(QuestStarterType giverType, uint32 giverEntry, const std::string& text) const;
+        size_t GetGossipTextCount() const { return gossipTexts.size(); }
+
+    private:
+        struct GossipText
+        {
+            std::string hash;
+            uint32 tokenCount = 0;
+        };
+
+        struct GossipKey
+        {
+            uint64 key;
+            uint32 textIndex;
+
+            bool operator<(const GossipKey& other) const { return key < other.key || (key == other.key && textIndex < other.textIndex); }
+        };
+
+        void AddGossipText(QuestStarterType giverType, uint32 giverEntry, const std::string& text, const std::string& hash);
+
+        static uint32 Tokenize(const std::string& text, std::vector<uint32>& tokenHashes);
+        static uint64 MakeGossipKey(QuestStarterType giverType, uint32 giverEntry, uint32 hash);
+
+    private:
+        std::vector<GossipText> gossipTexts;
+
+        // Sorted by key so a giver's entries are found with a binary search
+        std::vector<GossipKey> textHashes;
+        std::vector<GossipKey> tokenPostings;
+    };
+}
+#endif
@@ -0,0 +1,255 @@
+#include "VoiceoverIndexSnapshot.h"
+
+#include "Log/Log.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cmangos_module
+{
+    constexpr char SNAPSHOT_MAGIC[8] = { 'V', 'O', 'I', 'N', 'D', 'E', 'X', '\0' };
+
+    // Must be bumped whenever the file layout, a section record or the way its keys are hashed changes
+    constexpr uint32 SNAPSHOT_VERSION = 5;
+
+    // Records are stored as they are in memory, files written on a host of the other byte order are ignored
+    constexpr uint32 SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+    constexpr uint32 MAX_SNAPSHOT_SECTIONS = 8;
+    constexpr size_t SNAPSHOT_SECTION_ALIGNMENT = 8;
+    constexpr uint64 SNAPSHOT_CHECKSUM_SEED = 14695981039346656037ull;
+
+    struct SnapshotSectionHeader
+    {
+        uint32 id;
+        uint32 recordSize;
+        uint64 offset;
+        uint64 count;
+    };
+
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32 version;
+        uint32 byteOrder;
+        uint64 contentHash;
+        uint64 checksum;
+        uint64 fileSize;
+        uint32 sectionCount;
+        uint32 padding;
+        SnapshotSectionHeader sections[MAX_SNAPSHOT_SECTIONS];
+    };
+
+    // 64 bit FNV-1a over everything after the header
+    uint64 HashSnapshotData(uint64 hash, const uint8* data, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ data[i]) * 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    bool VoiceoverIndexSnapshot::Open(const std::string& fileName, uint64 contentHash)
+    {
+        Close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view)
+        {
+            if (mapping)
+            {
+                CloseHandle(mapping);
+            }
+
+            CloseHandle(file);
+            return false;
+        }
+
+        fileHandle = file;
+        mappingHandle = mapping;
+        data = static_cast<const uint8*>(view);
+        size = (size_t)fileSize.QuadPart;
+#else
+        const int file = open(fileName.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        // The mapping stays valid once the descriptor is closed
+        struct stat fileStat;
+        void* view = fstat(file, &fileStat) == 0 && fileStat.st_size > 0 ? mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+        close(file);
+        if (view == MAP_FAILED)
+        {
+            return false;
+        }
+
+        data = static_cast<const uint8*>(view);
+        size = (size_t)fileStat.st_size;
+#endif
+
+        const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(data);
+        if (size < sizeof(SnapshotHeader) || memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header->byteOrder != SNAPSHOT_BYTE_ORDER ||
+            header->fileSize != size || header->sectionCount > MAX_SNAPSHOT_SECTIONS)
+        {
+            sLog.outError("Voiceover: %s is not an index snapshot file or is incomplete", fileName.c_str());
+            Close();
+            return false;
+        }
+
+        if (header->version != SNAPSHOT_VERSION || header->contentHash != contentHash)
+        {
+            sLog.outString(">> Voiceover: index snapshot %s is outdated", fileName.c_str());
+            Close();
+            return false;
+        }
+
+        for (uint32 i = 0; i < header->sectionCount; ++i)
+        {
+            const SnapshotSectionHeader& section = header->sections[i];
+            if (section.offset % SNAPSHOT_SECTION_ALIGNMENT != 0 || section.offset > size || section.recordSize == 0 || section.count > (size - section.offset) / section.recordSize)
+            {
+                sLog.outError("Voiceover: index snapshot %s has an invalid section", fileName.c_str());
+                Close();
+                return false;
+            }
+        }
+
+        // Reads the whole file once, which also brings its pages in before the first lookup
+        if (HashSnapshotData(SNAPSHOT_CHECKSUM_SEED, data + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) != header->checksum)
+        {
+            sLog.outError("Voiceover: index snapshot %s is corrupted", fileName.c_str());
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void VoiceoverIndexSnapshot::Close()
+    {
+        if (data)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(data);
+            CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            mappingHandle = nullptr;
+            fileHandle = nullptr;
+#else
+            munmap(const_cast<uint8*>(data), size);
+#endif
+            data = nullptr;
+            size = 0;
+        }
+    }
+
+    const void* VoiceoverIndexSnapshot::GetSection(uint32 id, uint32 recordSize, size_t& count) const
+    {
+        count = 0;
+        if (data)
+        {
+            const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(data);
+            for (uint32 i = 0; i < header->sectionCount; ++i)
+            {
+                const SnapshotSectionHeader& section = header->sections[i];
+                if (section.id == id && section.recordSize == recordSize)
+                {
+                    count = (size_t)section.count;
+                    return data + section.offset;
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool VoiceoverIndexSnapshot::Write(const std::string& fileName, uint64 contentHash, const std::vector<Section>& sections)
+    {
+        if (sections.size() > MAX_SNAPSHOT_SECTIONS)
+        {
+            return false;
+        }
+
+        const std::string tempFileName = fileName + ".tmp";
+        std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            sLog.outError("Voiceover: can't write index snapshot file %s", tempFileName.c_str());
+            return false;
+        }
+
+        SnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.byteOrder = SNAPSHOT_BYTE_ORDER;
+        header.contentHash = contentHash;
+        header.sectionCount = (uint32)sections.size();
+
+        // The header is written last, once the checksum is known
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        const uint8 padding[SNAPSHOT_SECTION_ALIGNMENT] = {};
+        uint64 offset = sizeof(header);
+        uint64 checksum = SNAPSHOT_CHECKSUM_SEED;
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            const size_t paddingSize = (SNAPSHOT_SECTION_ALIGNMENT - offset % SNAPSHOT_SECTION_ALIGNMENT) % SNAPSHOT_SECTION_ALIGNMENT;
+            file.write(reinterpret_cast<const char*>(padding), paddingSize);
+            checksum = HashSnapshotData(checksum, padding, paddingSize);
+            offset += paddingSize;
+
+            const Section& section = sections[i];
+            const size_t sectionSize = (size_t)section.recordSize * section.count;
+            file.write(static_cast<const char*>(section.records), sectionSize);
+            checksum = HashSnapshotData(checksum, static_cast<const uint8*>(section.records), sectionSize);
+
+            header.sections[i] = { section.id, section.recordSize, offset, (uint64)section.count };
+            offset += sectionSize;
+        }
+
+        header.checksum = checksum;
+        header.fileSize = offset;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.close();
+
+        std::error_code error;
+        if (file)
+        {
+            std::filesystem::rename(tempFileName, fileName, error);
+        }
+
+        if (!file || error)
+        {
+            sLog.outError("Voiceover: can't write index snapshot file %s", fileName.c_str());
+            std::filesystem::remove(tempFileName, error);
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_INDEX_SNAPSHOT_H
+#define CMANGOS_MODULE_VOICEOVER_INDEX_SNAPSHOT_H
+
+#include "Platform/Define.h"
+
+#include <string>
+#include <vector>
+
+namespace cmangos_module
+{
+    // Prebuilt index sections (flat arrays of plain records) stored in a file that is mapped
+    // read-only, so several processes using the same file share its pages. The file is only
+    // used if its format version, the content hash of the data the indexes were built from
+    // and the checksum of the sections all match.
+    class VoiceoverIndexSnapshot
+    {
+    public:
+        struct Section
+        {
+            uint32 id;
+            uint32 recordSize;
+            const void* records;
+            size_t count;
+        };
+
+    public:
+        VoiceoverIndexSnapshot() {}
+        ~VoiceoverIndexSnapshot() { Close(); }
+
+        VoiceoverIndexSnapshot(const VoiceoverIndexSnapshot&) = delete;
+        VoiceoverIndexSnapshot& operator=(const VoiceoverIndexSnapshot&) = delete;
+
+        bool Open(const std::string& fileName, uint64 contentHash);
+        void Close();
+
+        // Records of the section or nullptr if the snapshot doesn't have it with records of that size
+        template<class T>
+        const T* GetSection(uint32 id, size_t& count) const { return static_cast<const T*>(GetSection(id, sizeof(T), count)); }
+
+        // Writes the file next to the old one and swaps them, processes still mapping the old file keep it
+        static bool Write(const std::string& fileName, uint64 contentHash, const std::vector<Section>& sections);
+
+    private:
+        const void* GetSection(uint32 id, uint32 recordSize, size_t& count) const;
+
+    private:
+        const uint8* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+}
+#endif
@@ -0,0 +1,103 @@
+#include "VoiceoverMetrics.h"
+
+namespace cmangos_module
+{
+    // Only the owning thread writes to its block, a load and a store are enough
+    inline void Increase(std::atomic<uint64>& value, uint64 amount)
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void VoiceoverMetrics::Add(MetricCounter counter, uint64 amount) const
+    {
+        Increase(GetThreadMetrics().counters[(uint8)counter], amount);
+    }
+
+    void VoiceoverMetrics::Record(MetricTimer timer, uint64 microseconds) const
+    {
+        uint32 bucket = 0;
+        while (bucket + 1 < HISTOGRAM_BUCKETS && (microseconds >> (bucket + 1)) != 0)
+        {
+            bucket++;
+        }
+
+        ThreadMetrics& metrics = GetThreadMetrics();
+        Increase(metrics.buckets[(uint8)timer][bucket], 1);
+        Increase(metrics.totalMicroseconds[(uint8)timer], microseconds);
+    }
+
+    VoiceoverMetrics::Snapshot VoiceoverMetrics::GetSnapshot() const
+    {
+        Snapshot snapshot;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<ThreadMetrics>& metrics : threadMetrics)
+        {
+            for (uint8 counter = 0; counter < (uint8)MetricCounter::MAX; ++counter)
+            {
+                snapshot.counters[counter] += metrics->counters[counter].load(std::memory_order_relaxed);
+            }
+
+            for (uint8 timer = 0; timer < (uint8)MetricTimer::MAX; ++timer)
+            {
+                Histogram& histogram = snapshot.timers[timer];
+                for (uint32 bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket)
+                {
+                    const uint64 count = metrics->buckets[timer][bucket].load(std::memory_order_relaxed);
+                    histogram.buckets[bucket] += count;
+                    histogram.count += count;
+                }
+
+                histogram.totalMicroseconds += metrics->totalMicroseconds[timer].load(std::memory_order_relaxed);
+            }
+        }
+
+        return snapshot;
+    }
+
+    std::atomic<uint64> nextMetricsInstanceId(1);
+
+    VoiceoverMetrics::VoiceoverMetrics()
+    : instanceId(nextMetricsInstanceId++)
+    {
+
+    }
+
+    VoiceoverMetrics::ThreadMetrics& VoiceoverMetrics::GetThreadMetrics() const
+    {
+        // The module is a singleton, remember the owner anyway so a second instance gets its own blocks.
+        // Owners are told apart by id as a new instance can take the address of a destroyed one.
+        thread_local uint64 ownerId = 0;
+        thread_local ThreadMetrics* metrics = nullptr;
+        if (ownerId != instanceId)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threadMetrics.push_back(std::make_unique<ThreadMetrics>());
+            metrics = threadMetrics.back().get();
+            ownerId = instanceId;
+        }
+
+        return *metrics;
+    }
+
+    uint64 VoiceoverMetrics::Histogram::GetPercentile(uint32 percentile) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        const uint64 rank = (count * percentile + 99) / 100;
+        uint64 seen = 0;
+        for (uint32 bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket)
+        {
+            seen += buckets[bucket];
+            if (seen >= rank)
+            {
+                return (uint64)1 << (bucket + 1);
+            }
+        }
+
+        return (uint64)1 << HISTOGRAM_BUCKETS;
+    }
+}
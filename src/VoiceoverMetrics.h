@@ -0,0 +1,122 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_METRICS_H
+#define CMANGOS_MODULE_VOICEOVER_METRICS_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cmangos_module
+{
+    enum class MetricCounter : uint8
+    {
+        ENABLE_ADDON_CALLS,
+        QUEST_LOG_CALLS,
+        SOUND_EVENT_CALLS,
+        COALESCED_REQUESTS,
+        RATE_LIMITED_REQUESTS,
+        ADDON_CHANNEL_REQUESTS,
+        PUSHED_SOUND_EVENTS,
+        QUEST_LOG_DELTAS,
+        QUEST_LOG_CATCH_UPS,
+        QUEST_LOG_RESYNCS,
+        QUEST_SUPPLIED_ID,
+        QUEST_TITLE_INDEX,
+        QUEST_TITLE_DISAMBIGUATED,
+        QUEST_UNRESOLVED,
+        QUEST_UNVOICED,
+        GOSSIP_RESOLVED,
+        GOSSIP_UNRESOLVED,
+        GOSSIP_UNVOICED,
+        CREATURE_TEXTS_HEARD,
+        CREATURE_TEXTS_UNVOICED,
+        CREATURE_TEXT_MESSAGES,
+        CREATURE_TEXTS_SENT,
+        ZONE_QUEST_HINTS,
+        ZONE_QUEST_HINT_MESSAGES,
+        PACKETS_SENT,
+        BATCHED_MESSAGES,
+        HELD_BACK_FLUSHES,
+        BYTES_SENT,
+        MAX
+    };
+
+    enum class MetricTimer : uint8
+    {
+        ENABLE_ADDON,
+        QUEST_LOG,
+        SOUND_EVENT,
+        SOUND_EVENT_RESOLVE,
+        MAX
+    };
+
+    // Counters and latency histograms of the module. Every thread writes to its own
+    // block with plain relaxed stores, reading sums the blocks of all the threads.
+    class VoiceoverMetrics
+    {
+    public:
+        // Latencies are kept in power of two microsecond buckets, the last one holds everything above
+        static constexpr uint32 HISTOGRAM_BUCKETS = 24;
+
+        struct Histogram
+        {
+            uint64 buckets[HISTOGRAM_BUCKETS] = {};
+            uint64 count = 0;
+            uint64 totalMicroseconds = 0;
+
+            // Upper bound in microseconds of the bucket holding the given percentile
+            uint64 GetPercentile(uint32 percentile) const;
+            uint64 GetAverage() const { return count ? totalMicroseconds / count : 0; }
+        };
+
+        struct Snapshot
+        {
+            uint64 counters[(uint8)MetricCounter::MAX] = {};
+            Histogram timers[(uint8)MetricTimer::MAX];
+
+            uint64 Get(MetricCounter counter) const { return counters[(uint8)counter]; }
+            const Histogram& Get(MetricTimer timer) const { return timers[(uint8)timer]; }
+        };
+
+        class ScopedTimer
+        {
+        public:
+            ScopedTimer(const VoiceoverMetrics& inMetrics, MetricTimer inTimer) : metrics(inMetrics), timer(inTimer), start(std::chrono::steady_clock::now()) {}
+            ~ScopedTimer() { metrics.Record(timer, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()); }
+
+        private:
+            const VoiceoverMetrics& metrics;
+            MetricTimer timer;
+            std::chrono::steady_clock::time_point start;
+        };
+
+    public:
+        VoiceoverMetrics();
+
+        void Add(MetricCounter counter, uint64 amount = 1) const;
+        void Record(MetricTimer timer, uint64 microseconds) const;
+
+        Snapshot GetSnapshot() const;
+
+    private:
+        struct ThreadMetrics
+        {
+            std::atomic<uint64> counters[(uint8)MetricCounter::MAX] = {};
+            std::atomic<uint64> buckets[(uint8)MetricTimer::MAX][HISTOGRAM_BUCKETS] = {};
+            std::atomic<uint64> totalMicroseconds[(uint8)MetricTimer::MAX] = {};
+        };
+
+        ThreadMetrics& GetThreadMetrics() const;
+
+    private:
+        const uint64 instanceId;
+
+        // Blocks are only added and outlive their threads, so nothing counted gets lost
+        mutable std::mutex mutex;
+        mutable std::vector<std::unique_ptr<ThreadMetrics>> threadMetrics;
+    };
+}
+#endif
@@ -3,543 +3,1905 @@
 #include "Globals/ObjectAccessor.h"
 #include "Globals/ObjectMgr.h"
 
+#include "Entities/Creature.h"
 #include "Entities/Player.h"
 #include "Entities/GossipDef.h"
 
 #include "World/World.h"
 
+#include "Chat/Chat.h"
+
+#include "Database/DatabaseEnv.h"
+
+#include "Log/Log.h"
+#include "Util/Timer.h"
+
+#include <algorithm>
+#include <atomic>
+
 #ifdef ENABLE_PLAYERBOTS
 #include "playerbot/PlayerbotAI.h"
 #endif
 
 namespace cmangos_module
 {
+    // Longest "prefix\tmessage" line the client accepts in a single addon message
+    constexpr size_t MAX_ADDON_MESSAGE_LENGTH = 254;
+    constexpr char QUEST_LOG_SNAPSHOT_SEPARATOR = '^';
+
+    // Largest addon message the module formats, longer ones are truncated
+    constexpr size_t ADDON_MESSAGE_BUFFER_SIZE = 2048;
+
+    // Room for the SMSG_MESSAGECHAT fields around the message text
+    constexpr size_t CHAT_PACKET_HEADER_SIZE = 64;
+
+    // Request kinds that aren't sound events, used for the request keys
+    constexpr uint8 REQUEST_ENABLE_ADDON = 0xFE;
+    constexpr uint8 REQUEST_QUEST_LOG = 0xFF;
+
+    // Message names of each protocol version, v2 shortens them to a single character
+    const char* GetSoundEventName(AddonProtocol protocol) { return protocol == AddonProtocol::V2 ? "S" : "SoundEvent"; }
+    const char* GetQuestLogHeader(AddonProtocol protocol) { return protocol == AddonProtocol::V2 ? "L#%u;" : "QuestLog#%u;"; }
+    const char* GetQuestSnapshotName(AddonProtocol protocol) { return protocol == AddonProtocol::V2 ? "Q" : "QuestSnapshot"; }
+
+    uint64 MakeRequestKey(uint8 kind, uint32 id, uint32 textHash)
+    {
+        // [kind:8][id:24][text hash:32], the kind is never 0 so neither is a key
+        return ((uint64)kind << 56) | ((uint64)(id & 0xFFFFFF) << 32) | (uint64)textHash;
+    }
+
     VoiceoverPlayerMgr::VoiceoverPlayerMgr(Player* inPlayer, VoiceoverModule* inModule)
     : player(inPlayer)
     , module(inModule)
+    , capabilities(0)
     , addonEnabled(false)
+    , savedCapabilities(0)
+    , savedQuestLogHash(0)
+    , requestTokens(inModule->GetConfig()->rateLimitBurst * 1000)
+    , lastRequestTime(WorldTimer::getMSTime())
+    , nextRecentRequest(0)
+    , nextPushedEvent(0)
+    , questLogDeltaCount(0)
+    , listenerMapKey(0)
+    , hintZoneId(0)
+    , hintAreaId(0)
     {
-        
-    }
-
-    VoiceoverModule::VoiceoverModule()
-    : Module("Voiceover", new VoiceoverModuleConfig())
-    {
-
+        // Every session numbers the changes from a different point, so a sequence number the
+        // addon kept from an earlier session can't be mistaken for one of this session
+        const uint32 playerId = inPlayer ? inPlayer->GetObjectGuid().GetCounter() : 0;
+        questLogSequence = ((WorldTimer::getMSTime() ^ playerId) * 2654435761u) & 0x3FFFFFFF;
     }
 
-    const VoiceoverModuleConfig* VoiceoverModule::GetConfig() const
+    RequestResult VoiceoverPlayerMgr::CheckRequest(uint64 requestKey, RequestDedupe dedupe)
     {
-        return (VoiceoverModuleConfig*)Module::GetConfig();
-    }
+        const VoiceoverModuleConfig* config = module->GetConfig();
+        const uint32 now = WorldTimer::getMSTime();
 
-    void VoiceoverModule::OnCharacterCreated(Player* player)
-    {
-        if (GetConfig()->enabled)
+        // Repeated requests don't use up the rate limit, there is nothing new to answer
+        if (config->dedupeWindow > 0 && dedupe == RequestDedupe::WINDOW)
         {
-            if (player)
+            for (const RecentRequest& recentRequest : recentRequests)
             {
-#ifdef ENABLE_PLAYERBOTS
-                // Don't allow bot characters
-                if (!player->isRealPlayer())
-                    return;
-#endif
-                // Create the player manager
-                const uint32 playerId = player->GetObjectGuid().GetCounter();
-                playerMgrs.insert(std::make_pair(playerId, VoiceoverPlayerMgr(player, this)));
+                if (recentRequest.key == requestKey && WorldTimer::getMSTimeDiff(recentRequest.time, now) < config->dedupeWindow)
+                {
+                    return RequestResult::COALESCED;
+                }
             }
         }
-    }
-
-    void VoiceoverModule::OnPreLoadFromDB(Player* player)
-    {
-        if (GetConfig()->enabled)
+        else if (config->dedupeWindow > 0 && dedupe == RequestDedupe::IN_FLIGHT)
         {
-            if (player)
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            for (const uint64 inFlightRequest : inFlightRequests)
             {
-#ifdef ENABLE_PLAYERBOTS
-                // Don't allow bot characters
-                if (!player->isRealPlayer())
-                    return;
-#endif
-                // Create the player manager
-                const uint32 playerId = player->GetObjectGuid().GetCounter();
-                playerMgrs.insert(std::make_pair(playerId, VoiceoverPlayerMgr(player, this)));
+                if (inFlightRequest == requestKey)
+                {
+                    return RequestResult::COALESCED;
+                }
             }
         }
-    }
 
-    void VoiceoverModule::OnLogOut(Player* player)
-    {
-        if (GetConfig()->enabled)
+        // The handshakes are already bounded by the dedupe window. A rate limited one would leave the addon
+        // waiting for its reply for the rest of the session.
+        if (config->rateLimitBurst > 0 && dedupe != RequestDedupe::WINDOW)
         {
-            if (player)
+            const uint64 refill = (uint64)WorldTimer::getMSTimeDiff(lastRequestTime, now) * config->rateLimitPerSecond;
+            requestTokens = (uint32)std::min<uint64>(requestTokens + refill, config->rateLimitBurst * 1000);
+            lastRequestTime = now;
+
+            if (requestTokens < 1000)
             {
-                // Delete the player achievement manager
-                const uint32 playerId = player->GetObjectGuid().GetCounter();
-                playerMgrs.erase(playerId);
+                return RequestResult::RATE_LIMITED;
             }
+
+            requestTokens -= 1000;
         }
-    }
 
-    std::string GetObjectTypeStrFromGuid(const ObjectGuid& guid)
-    {
-        switch (guid.GetHigh())
+        if (dedupe == RequestDedupe::WINDOW)
         {
-            case HighGuid::HIGHGUID_PLAYER: return "Player";
-            case HighGuid::HIGHGUID_ITEM: return "Item";
-            case HighGuid::HIGHGUID_UNIT:
-            case HighGuid::HIGHGUID_PET: return "Creature";
-            case HighGuid::HIGHGUID_GAMEOBJECT: return "GameObject";
-            default: return "";
+            recentRequests[nextRecentRequest] = { requestKey, now };
+            nextRecentRequest = (nextRecentRequest + 1) % MAX_RECENT_REQUESTS;
         }
-    }
-
-    struct QuestInfo
-    {
-        bool valid = false;
-        uint32 questID = 0;
-        uint32 questgiverID = 0;
-        std::string questTitle = "";
-        std::string questGiverName = "";
-        std::string questGiverGUID = "";
-    };
-
-    std::string GetQuestTitleByLocale(const Quest* quest, int localeIndex)
-    {
-        std::string questTitle;
-        if (quest)
+        else if (dedupe == RequestDedupe::IN_FLIGHT)
         {
-            questTitle = quest->GetTitle();
-            if (localeIndex >= 0)
+            // Requests past the ones kept are still answered, only not coalesced
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            for (uint64& inFlightRequest : inFlightRequests)
             {
-                if (const QuestLocale* questLocale = sObjectMgr.GetQuestLocale(quest->GetQuestId()))
+                if (inFlightRequest == 0)
                 {
-                    if (questLocale->Title.size() > (size_t)localeIndex && !questLocale->Title[localeIndex].empty())
-                    {
-                        questTitle = questLocale->Title[localeIndex];
-                    }
+                    inFlightRequest = requestKey;
+                    break;
                 }
             }
         }
 
-        return questTitle;
+        return RequestResult::ACCEPTED;
     }
 
-    QuestInfo GetQuestInfo(const Player* player, const Quest* quest, const ObjectGuid* questGiverGuid = nullptr)
+    void VoiceoverPlayerMgr::FinishRequest(uint64 requestKey)
     {
-        QuestInfo result;
-        if (player && quest)
+        if (requestKey != 0)
         {
-            result.questID = quest->GetQuestId();
-
-            std::string objectTypeStr = "Creature";
-            if (questGiverGuid && !questGiverGuid->IsEmpty())
-            {
-                result.questgiverID = questGiverGuid->GetEntry();
-                objectTypeStr = GetObjectTypeStrFromGuid(*questGiverGuid);
-            }
-            else
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            for (uint64& inFlightRequest : inFlightRequests)
             {
-                for (auto [entry, questID] : sObjectMgr.GetCreatureQuestRelationsMap())
+                if (inFlightRequest == requestKey)
                 {
-                    if (result.questID == questID)
-                    {
-                        result.questgiverID = entry;
-                        break;
-                    }
+                    inFlightRequest = 0;
+                    break;
                 }
             }
+        }
+    }
 
-            const int localeIndex = player->GetSession()->GetSessionDbLocaleIndex();
-            result.questTitle = GetQuestTitleByLocale(quest, localeIndex);
-
-            if (localeIndex >= 0)
-            {
-                const char* questGiverName = nullptr;
-                sObjectMgr.GetCreatureLocaleStrings(result.questgiverID, localeIndex, &questGiverName);
-                result.questGiverName = questGiverName ? questGiverName : "";
-            }
-
-            if (result.questGiverName.empty())
+    bool VoiceoverPlayerMgr::MarkEventPushed(uint64 eventKey)
+    {
+        if (module->GetConfig()->dedupeWindow > 0)
+        {
+            for (const uint64 pushedEvent : pushedEvents)
             {
-                if (const CreatureInfo* creatureInfo = sObjectMgr.GetCreatureTemplate(result.questgiverID))
+                if (pushedEvent == eventKey)
                 {
-                    result.questGiverName = creatureInfo->Name;
+                    return false;
                 }
             }
-
-            std::ostringstream guidStr;
-            guidStr << objectTypeStr << "-0-0-0-0-" << result.questgiverID << "-0";
-            result.questGiverGUID = guidStr.str();
-            result.valid = true;
         }
 
-        return result;
+        pushedEvents[nextPushedEvent] = eventKey;
+        nextPushedEvent = (nextPushedEvent + 1) % MAX_RECENT_REQUESTS;
+        return true;
     }
 
-    void VoiceoverModule::OnAcceptQuest(Player* player, uint32 questId, const ObjectGuid* questGiver)
+    void VoiceoverPlayerMgr::ClearPushedEvents()
     {
-        if (GetConfig()->enabled && player)
-        {
-#ifdef ENABLE_PLAYERBOTS
-            // Don't allow bot characters
-            if (!player->isRealPlayer())
-                return false;
-#endif
+        std::fill(std::begin(pushedEvents), std::end(pushedEvents), 0);
+        nextPushedEvent = 0;
+    }
 
-            if (IsAddonEnabled(player))
-            {
-                if (const Quest* quest = sObjectMgr.GetQuestTemplate(questId))
-                {
-                    const uint8 wasAdded = 1;
-                    const QuestInfo questInfo = GetQuestInfo(player, quest, questGiver);
+    uint32 VoiceoverPlayerMgr::ResetQuestLog(const std::vector<uint32>& questIds)
+    {
+        std::lock_guard<std::mutex> lock(questLogMutex);
+        questLogIds = questIds;
+        return questLogSequence;
+    }
 
-                    PSendAddonMessage(player, "QuestLog#%u;%u;%s;%s;%s",
-                        wasAdded,
-                        questInfo.questID,
-                        questInfo.questGiverGUID.c_str(),
-                        questInfo.questTitle.c_str(),
-                        questInfo.questGiverName.c_str());
-                }
-            }
+    bool VoiceoverPlayerMgr::AddQuestLogDelta(uint32 questId, const ObjectGuid* questGiver, bool added, QuestLogDelta& delta)
+    {
+        std::lock_guard<std::mutex> lock(questLogMutex);
+        auto questIt = std::find(questLogIds.begin(), questLogIds.end(), questId);
+        if (added == (questIt != questLogIds.end()))
+        {
+            return false;
+        }
+
+        if (added)
+        {
+            questLogIds.push_back(questId);
+        }
+        else
+        {
+            questLogIds.erase(questIt);
         }
+
+        delta.sequence = ++questLogSequence;
+        delta.questId = questId;
+        delta.questGiver = questGiver ? *questGiver : ObjectGuid();
+        delta.added = added;
+
+        questLogDeltas[questLogDeltaCount % MAX_QUEST_LOG_DELTAS] = delta;
+        questLogDeltaCount++;
+        return true;
     }
 
-    void VoiceoverModule::OnAbandonQuest(Player* player, uint32 questId)
+    bool VoiceoverPlayerMgr::GetQuestLogDeltas(uint32 sinceSequence, std::vector<QuestLogDelta>& deltas) const
     {
-        if (GetConfig()->enabled && player)
+        std::lock_guard<std::mutex> lock(questLogMutex);
+        const uint32 keptDeltas = std::min<uint32>(questLogDeltaCount, MAX_QUEST_LOG_DELTAS);
+        if (sinceSequence > questLogSequence || questLogSequence - sinceSequence > keptDeltas)
         {
-#ifdef ENABLE_PLAYERBOTS
-            // Don't allow bot characters
-            if (!player->isRealPlayer())
-                return false;
-#endif
+            return false;
+        }
 
-            if (IsAddonEnabled(player))
-            {
-                if (const Quest* quest = sObjectMgr.GetQuestTemplate(questId))
-                {
-                    const uint8 wasAdded = 0;
-                    const QuestInfo questInfo = GetQuestInfo(player, quest);
+        for (uint32 sequence = sinceSequence + 1; sequence <= questLogSequence; ++sequence)
+        {
+            // The delta count and the sequence number grow together
+            const uint32 deltaIndex = questLogDeltaCount - (questLogSequence - sequence) - 1;
+            deltas.push_back(questLogDeltas[deltaIndex % MAX_QUEST_LOG_DELTAS]);
+        }
 
-                    PSendAddonMessage(player, "QuestLog#%u;%u;%s;%s;%s",
-                        wasAdded,
-                        questInfo.questID,
-                        questInfo.questGiverGUID.c_str(),
-                        questInfo.questTitle.c_str(),
-                        questInfo.questGiverName.c_str());
-                }
-            }
+        return true;
+    }
+
+    bool VoiceoverPlayerMgr::SetHintLocation(uint32 zoneId, uint32 areaId)
+    {
+        if (zoneId == hintZoneId && areaId == hintAreaId)
+        {
+            return false;
         }
+
+        hintZoneId = zoneId;
+        hintAreaId = areaId;
+        return true;
     }
 
-    void VoiceoverModule::SendAddonMessage(const Player* player, const char* message) const
+    bool VoiceoverPlayerMgr::MarkZoneHinted(uint32 zoneId)
     {
-        if (IsAddonEnabled(player))
+        if (std::find(hintedZones.begin(), hintedZones.end(), zoneId) != hintedZones.end())
         {
-            WorldPacket data;
+            return false;
+        }
 
-            std::ostringstream out;
-            out << GetChatCommandPrefix() << "\t" << message;
+        hintedZones.push_back(zoneId);
+        return true;
+    }
 
-            char* buf = mangos_strdup(out.str().c_str());
-            char* pos = buf;
+    void VoiceoverPlayerMgr::ResetZoneQuestHints()
+    {
+        hintZoneId = 0;
+        hintAreaId = 0;
+        hintedZones.clear();
+    }
 
-            while (char* line = ChatHandler::LineFromMessage(pos))
-            {
-#if EXPANSION == 0
-                ChatHandler::BuildChatPacket(data, CHAT_MSG_ADDON, line, LANG_ADDON);
-#else
-                ChatHandler::BuildChatPacket(data, CHAT_MSG_WHISPER, line, LANG_ADDON);
-#endif
-                player->GetSession()->SendPacket(data);
-            }
+    VoiceoverModule::VoiceoverModule()
+    : Module("Voiceover", new VoiceoverModuleConfig())
+    , calledHookCapabilities(0)
+    , questIndex(std::make_shared<VoiceoverQuestIndex>())
+    , gossipIndex(std::make_shared<VoiceoverGossipIndex>())
+    , voiceManifest(std::make_shared<VoiceoverVoiceManifest>())
+    , zoneIndex(std::make_shared<VoiceoverZoneIndex>())
+    {
 
-            delete[] buf;
-        }
     }
 
-    void VoiceoverModule::PSendAddonMessage(const Player* player, const char* format, ...) const
+    VoiceoverModule::~VoiceoverModule()
     {
-        if (player)
-        {
-            va_list ap;
-            char str[2048];
-            va_start(ap, format);
-            vsnprintf(str, 2048, format, ap);
-            va_end(ap);
+        // The workers reference the module, they must be gone before anything else is destroyed
+        resolverPool.Stop();
+    }
 
-            SendAddonMessage(player, str);
-        }
+    const VoiceoverModuleConfig* VoiceoverModule::GetConfig() const
+    {
+        return (VoiceoverModuleConfig*)Module::GetConfig();
     }
 
-    std::vector<ModuleChatCommand>* VoiceoverModule::GetCommandTable()
+    void VoiceoverModule::OnInitialize()
     {
-        static std::vector<ModuleChatCommand> commandTable =
+        if (GetConfig()->enabled)
         {
-            { "enableAddon", std::bind(&VoiceoverModule::HandleEnableAddon, this, std::placeholders::_1, std::placeholders::_2), SEC_PLAYER },
-            { "questLog", std::bind(&VoiceoverModule::HandleQuestLogRequest, this, std::placeholders::_1, std::placeholders::_2), SEC_PLAYER },
-            { "soundEvent", std::bind(&VoiceoverModule::HandleSoundEventRequest, this, std::placeholders::_1, std::placeholders::_2), SEC_PLAYER }
-        };
+            LoadIndexes();
 
-        return &commandTable;
+            if (GetConfig()->resolverThreads > 0)
+            {
+                resolverPool.Start(GetConfig()->resolverThreads);
+                sLog.outString(">> Voiceover: resolving sound events on %u threads", GetConfig()->resolverThreads);
+            }
+        }
     }
 
-    bool VoiceoverModule::HandleEnableAddon(WorldSession* session, const std::string& args)
+    void VoiceoverModule::OnUpdate(uint32 elapsed)
     {
-        if (GetConfig()->enabled && session)
+        if (GetConfig()->enabled)
         {
-            Player* player = session->GetPlayer();
-            if (player)
+            // Write the replies of the sound events the workers resolved and hand them to their players
+            completedSoundEvents.Drain([this](SoundEventResult& result)
             {
-#ifdef ENABLE_PLAYERBOTS
-                // Don't allow bot characters
-                if (!player->isRealPlayer())
-                    return false;
-#endif
-
-                bool addonEnabled = false;
-                if (VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+                if (Player* player = ObjectAccessor::FindPlayer(result.request.playerGuid))
                 {
-                    addonEnabled = playerMgr->IsAddonEnabled();
-                    if (!addonEnabled)
-                    {
-                        playerMgr->EnableAddon();
-                        addonEnabled = true;
-                    }
+                    SendSoundEvent(player, result);
                 }
+            });
+
+            SendCreatureTexts();
+
+            // No thread holds on to a player state across world updates
+            playerMgrs.Reclaim();
 
-                if (addonEnabled)
+            if (GetConfig()->statsLogInterval > 0)
+            {
+                statsLogTimer += elapsed;
+                if (statsLogTimer >= GetConfig()->statsLogInterval * IN_MILLISECONDS)
                 {
-                    SendAddonMessage(player, "AddonEnabled");
+                    statsLogTimer = 0;
+                    for (const std::string& line : FormatStats())
+                    {
+                        sLog.outString("Voiceover: %s", line.c_str());
+                    }
                 }
-
-                return true;
             }
         }
-
-        return false;
     }
 
-    bool VoiceoverModule::HandleQuestLogRequest(WorldSession* session, const std::string& args)
+    void VoiceoverModule::OnPreLoadFromDB(Player* player)
     {
-        if (GetConfig()->enabled && session)
+        if (GetConfig()->enabled)
         {
-            Player* player = session->GetPlayer();
             if (player)
             {
-#ifdef ENABLE_PLAYERBOTS
-                // Don't allow bot characters
-                if (!player->isRealPlayer())
-                    return false;
-#endif
-
-                if (IsAddonEnabled(player))
-                {
-                    for (uint8 slot = 0; slot < MAX_QUEST_LOG_SIZE; ++slot)
-                    {
-                        if (const Quest* quest = sObjectMgr.GetQuestTemplate(player->GetQuestSlotQuestId(slot)))
-                        {
-                            const uint8 wasAdded = 1;
-                            const QuestInfo questInfo = GetQuestInfo(player, quest);
-
-                            PSendAddonMessage(player, "QuestLog#%u;%u;%s;%s;%s",
-                                wasAdded,
-                                questInfo.questID,
-                                questInfo.questGiverGUID.c_str(),
-                                questInfo.questTitle.c_str(),
-                                questInfo.questGiverName.c_str());
-                        }
-                    }
-
-                    return true;
-                }
+                // The addon has to enable itself again on every login
+                const uint32 playerId = player->GetObjectGuid().GetCounter();
+                playerMgrs.Erase(playerId);
+                creatureTexts.RemoveListener(player->GetObjectGuid());
             }
         }
-
-        return false;
     }
 
-    std::string toLower(std::string str) 
+    void VoiceoverModule::OnSaveToDB(Player* player)
     {
-        std::transform(str.begin(), str.end(), str.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-        return str;
+        if (GetConfig()->enabled)
+        {
+            SavePlayerState(player);
+        }
     }
 
-    bool VoiceoverModule::HandleSoundEventRequest(WorldSession* session, const std::string& args)
+    void VoiceoverModule::OnLogOut(Player* player)
     {
-        if (GetConfig()->enabled && session)
+        if (GetConfig()->enabled)
         {
-            Player* player = session->GetPlayer();
             if (player)
             {
-#ifdef ENABLE_PLAYERBOTS
-                // Don't allow bot characters
-                if (!player->isRealPlayer())
-                    return false;
-#endif
-
-                if (IsAddonEnabled(player))
-                {
-                    std::vector<std::string> arguments = helper::SplitString(args, ";");
-                    if (arguments.size() == 3)
-                    {
-                        const SoundEvent eventType = helper::IsValidNumberString(arguments[0]) ? static_cast<SoundEvent>(stoi(arguments[0])) : SoundEvent::INVALID;
-                        uint32 id = helper::IsValidNumberString(arguments[1]) ? stoi(arguments[1]) : 0;
-                        const std::string eventTitle = toLower(arguments[2]);
-
-                        if (eventType != SoundEvent::INVALID)
-                        {
-                            const bool isQuestEvent = eventType == SoundEvent::QUEST_ACCEPT || eventType == SoundEvent::QUEST_PROGRESS || eventType == SoundEvent::QUEST_COMPLETE;
-                            const ObjectGuid& targetGuid = player->GetSelectionGuid();
-                            if (id == 0 && !targetGuid.IsEmpty())
-                            {
-                                // Try to guess the id based on the event type and the current target of the player
-                                if (isQuestEvent && !eventTitle.empty())
-                                {
-                                    const int localeIndex = player->GetSession()->GetSessionDbLocaleIndex();
-                                    if (PlayerMenu* playerMenu = player->GetPlayerMenu())
-                                    {
-                                        QuestMenu& questMenu = playerMenu->GetQuestMenu();
-                                        
-                                        for (uint32 i = 0; i < questMenu.MenuItemCount(); ++i)
-                                        {
-                                            const QuestMenuItem& menuItem = questMenu.GetItem(i);
-                                            if ((eventType == SoundEvent::QUEST_ACCEPT && menuItem.m_qIcon == DIALOG_STATUS_AVAILABLE) ||
-                                                (eventType == SoundEvent::QUEST_PROGRESS && menuItem.m_qIcon == DIALOG_STATUS_INCOMPLETE) ||
-                                                (eventType == SoundEvent::QUEST_COMPLETE && menuItem.m_qIcon == DIALOG_STATUS_REWARD_REP))
-                                            {
-                                                const uint32 questID = menuItem.m_qId;
-                                                if (const Quest* quest = sObjectMgr.GetQuestTemplate(questID))
-                                                {
-                                                    const std::string questTitle = toLower(GetQuestTitleByLocale(quest, localeIndex));
-                                                    if (questTitle == eventTitle)
-                                                    {
-                                                        id = questID;
-                                                        break;
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-
-                                    if (id == 0)
-                                    {
-                                        const uint32 targetEntry = targetGuid.GetEntry();
-                                        QuestRelationsMapBounds bounds = sObjectMgr.GetCreatureQuestRelationsMapBounds(targetEntry);
-                                        for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-                                        {
-                                            const uint32 questID = itr->second;
-                                            if (const Quest* quest = sObjectMgr.GetQuestTemplate(questID))
-                                            {
-                                                const std::string questTitle = toLower(GetQuestTitleByLocale(quest, localeIndex));
-                                                if (questTitle == eventTitle)
-                                                {
-                                                    id = questID;
-                                                    break;
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-
-                            if (id != 0)
-                            {
-                                if (isQuestEvent)
-                                {
-                                    if (const Quest* quest = sObjectMgr.GetQuestTemplate(id))
-                                    {
-                                        const QuestInfo questInfo = GetQuestInfo(player, quest, &targetGuid);
-
-                                        PSendAddonMessage(player, "SoundEvent#%u;%u;%s;%s;%s",
-                                            eventType,
-                                            questInfo.questID,
-                                            questInfo.questGiverGUID.c_str(),
-                                            questInfo.questTitle.c_str(),
-                                            questInfo.questGiverName.c_str());
-                                    }
-                                }
-                            }
-                        }
-                    }
+                SavePlayerState(player);
 
-                    return true;
-                }
+                // Delete the player voiceover manager
+                const uint32 playerId = player->GetObjectGuid().GetCounter();
+                playerMgrs.Erase(playerId);
+                creatureTexts.RemoveListener(player->GetObjectGuid());
             }
         }
-
-        return false;
     }
 
-    VoiceoverPlayerMgr* VoiceoverModule::GetVoiceoverPlayerMgr(Player* player)
+    void VoiceoverModule::OnUpdate(Player* player, uint32 diff)
     {
         if (GetConfig()->enabled)
         {
-            VoiceoverPlayerMgr* playerMgr = nullptr;
-            if (player)
+            if (VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
             {
-#ifdef ENABLE_PLAYERBOTS
-                // Don't allow bot characters
-                if (!player->isRealPlayer())
-                    return false;
-#endif
+                // Follow the player to the map it moved to, which only takes the listeners lock on a map change
+                if (playerMgr->HasCapability(AddonCapability::CREATURE_TEXTS))
+                {
+                    const uint64 mapKey = VoiceoverCreatureTexts::MakeMapKey(player->GetMapId(), player->GetInstanceId());
+                    if (mapKey != playerMgr->GetListenerMapKey())
+                    {
+                        creatureTexts.AddListener(player->GetObjectGuid(), mapKey);
+                        playerMgr->SetListenerMapKey(mapKey);
+                    }
+                }
 
-                const uint32 playerId = player->GetObjectGuid().GetCounter();
-                auto playerMgrIt = playerMgrs.find(playerId);
-                if (playerMgrIt != playerMgrs.end())
+                if (playerMgr->HasCapability(AddonCapability::ZONE_QUEST_HINTS))
+                {
+                    SendZoneQuestHints(player, playerMgr);
+                }
+
+                // Everything the player got since the last update goes out together
+                VoiceoverOutboundQueue& queue = playerMgr->GetOutboundQueue();
+                if (!queue.IsEmpty())
                 {
-                    playerMgr = &playerMgrIt->second;
+                    FlushAddonMessages(player, queue);
                 }
 
-                MANGOS_ASSERT(playerMgr);
-                return playerMgr;
+                playerMgr->ClearPushedEvents();
             }
         }
-
-        return nullptr;
     }
 
-    const VoiceoverPlayerMgr* VoiceoverModule::GetVoiceoverPlayerMgr(const Player* player) const
+    void VoiceoverModule::OnCharacterDeleted(uint32 playerId)
     {
         if (GetConfig()->enabled)
         {
-            const VoiceoverPlayerMgr* playerMgr = nullptr;
-            if (player)
-            {
-#ifdef ENABLE_PLAYERBOTS
-                // Don't allow bot characters
-                if (!player->isRealPlayer())
-                    return false;
-#endif
+            CharacterDatabase.PExecute("DELETE FROM custom_voiceover_character WHERE guid = '%u'", playerId);
+        }
+    }
 
-                const uint32 playerId = player->GetObjectGuid().GetCounter();
-                auto playerMgrIt = playerMgrs.find(playerId);
-                if (playerMgrIt != playerMgrs.end())
+    void VoiceoverModule::LoadPlayerState(const Player* player, VoiceoverPlayerMgr* playerMgr)
+    {
+        auto result = CharacterDatabase.PQuery("SELECT capabilities, quest_log_hash FROM custom_voiceover_character WHERE guid = '%u'", player->GetObjectGuid().GetCounter());
+        if (result)
+        {
+            Field* fields = result->Fetch();
+            playerMgr->SetSavedState(fields[0].GetUInt32(), fields[1].GetUInt32());
+        }
+    }
+
+    void VoiceoverModule::SavePlayerState(const Player* player)
+    {
+        if (player)
+        {
+            // Only sessions that used the addon kept its quest log up to date
+            const uint32 playerId = player->GetObjectGuid().GetCounter();
+            VoiceoverPlayerMgr* playerMgr = playerMgrs.Find(playerId);
+            if (playerMgr && playerMgr->IsAddonEnabled())
+            {
+                const uint32 capabilities = playerMgr->GetCapabilities();
+                const uint32 questLogHash = GetQuestLogHash(player);
+                if (capabilities != playerMgr->GetSavedCapabilities() || questLogHash != playerMgr->GetSavedQuestLogHash())
                 {
-                    playerMgr = &playerMgrIt->second;
+                    CharacterDatabase.PExecute("REPLACE INTO custom_voiceover_character (guid, capabilities, quest_log_hash) VALUES ('%u', '%u', '%u')", playerId, capabilities, questLogHash);
+                    playerMgr->SetSavedState(capabilities, questLogHash);
                 }
-
-                MANGOS_ASSERT(playerMgr);
-                return playerMgr;
             }
         }
-
-        return nullptr;
     }
 
-    bool VoiceoverModule::IsAddonEnabled(const Player* player) const
+    uint32 VoiceoverModule::GetQuestLogHash(const Player* player) const
     {
-        if (player)
+        // The addon computes the same hash over its own copy of the quest log: the sorted
+        // quest ids and then their count folded as hash = (hash * 65599 + value) % 4294967291.
+        // Every step stays below 2^53 so Lua numbers (doubles) get the exact same result.
+        constexpr uint64 QUEST_LOG_HASH_MULTIPLIER = 65599;
+        constexpr uint64 QUEST_LOG_HASH_MODULUS = 4294967291u;
+
+        // Unvoiced quests are never sent, so the addon copy doesn't have them either
+        const std::shared_ptr<const VoiceoverVoiceManifest> manifest = GetVoiceManifest();
+
+        uint32 questIds[MAX_QUEST_LOG_SIZE];
+        uint32 questCount = 0;
+        for (uint8 slot = 0; slot < MAX_QUEST_LOG_SIZE; ++slot)
         {
-            if (const VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+            const uint32 questId = player->GetQuestSlotQuestId(slot);
+            if (questId && manifest->IsQuestVoiced(questId))
             {
-                return playerMgr->IsAddonEnabled();
+                questIds[questCount++] = questId;
             }
         }
 
-        return false;
+        std::sort(questIds, questIds + questCount);
+
+        uint64 hash = 0;
+        for (uint32 i = 0; i < questCount; ++i)
+        {
+            hash = (hash * QUEST_LOG_HASH_MULTIPLIER + questIds[i]) % QUEST_LOG_HASH_MODULUS;
+        }
+
+        return (uint32)((hash * QUEST_LOG_HASH_MULTIPLIER + questCount) % QUEST_LOG_HASH_MODULUS);
+    }
+
+    std::vector<uint32> VoiceoverModule::GetVoicedQuestLog(const Player* player) const
+    {
+        const std::shared_ptr<const VoiceoverVoiceManifest> manifest = GetVoiceManifest();
+
+        std::vector<uint32> questIds;
+        questIds.reserve(MAX_QUEST_LOG_SIZE);
+        for (uint8 slot = 0; slot < MAX_QUEST_LOG_SIZE; ++slot)
+        {
+            const uint32 questId = player->GetQuestSlotQuestId(slot);
+            if (questId && sObjectMgr.GetQuestTemplate(questId) && manifest->IsQuestVoiced(questId))
+            {
+                questIds.push_back(questId);
+            }
+        }
+
+        return questIds;
+    }
+
+    VoicedQuestLine GetVoicedQuestLine(SoundEvent eventType)
+    {
+        switch (eventType)
+        {
+            case SoundEvent::QUEST_ACCEPT: return VoicedQuestLine::ACCEPT;
+            case SoundEvent::QUEST_PROGRESS: return VoicedQuestLine::PROGRESS;
+            case SoundEvent::QUEST_COMPLETE: return VoicedQuestLine::COMPLETE;
+            default: return VoicedQuestLine::MAX;
+        }
+    }
+
+    QuestTextType GetQuestTextType(SoundEvent eventType)
+    {
+        switch (eventType)
+        {
+            case SoundEvent::QUEST_PROGRESS: return QuestTextType::REQUEST_ITEMS;
+            case SoundEvent::QUEST_COMPLETE: return QuestTextType::OFFER_REWARD;
+            default: return QuestTextType::DETAILS;
+        }
+    }
+
+    QuestStarterType GetStarterTypeFromGuid(const ObjectGuid& guid)
+    {
+        switch (guid.GetHigh())
+        {
+            case HighGuid::HIGHGUID_ITEM: return QuestStarterType::ITEM;
+            case HighGuid::HIGHGUID_UNIT:
+            case HighGuid::HIGHGUID_PET: return QuestStarterType::CREATURE;
+            case HighGuid::HIGHGUID_GAMEOBJECT: return QuestStarterType::GAMEOBJECT;
+            default: return QuestStarterType::NONE;
+        }
+    }
+
+    QuestPayload VoiceoverModule::GetQuestPayload(const Player* player, const Quest* quest, const ObjectGuid* questGiverGuid)
+    {
+        QuestPayload payload;
+        if (player && quest)
+        {
+            QuestStarterType questGiverType = QuestStarterType::NONE;
+            uint32 questGiverEntry = 0;
+            if (questGiverGuid && !questGiverGuid->IsEmpty())
+            {
+                questGiverType = GetStarterTypeFromGuid(*questGiverGuid);
+                questGiverEntry = questGiverGuid->GetEntry();
+            }
+
+            const int localeIndex = player->GetSession()->GetSessionDbLocaleIndex();
+            payload = GetQuestPayload(quest, questGiverType, questGiverEntry, localeIndex, GetAddonProtocol(player));
+        }
+
+        return payload;
+    }
+
+    QuestPayload VoiceoverModule::GetQuestPayload(const Quest* quest, QuestStarterType questGiverType, uint32 questGiverEntry, int localeIndex, AddonProtocol protocol)
+    {
+        QuestPayload payload;
+        if (quest)
+        {
+            ResolveQuestGiver(quest, questGiverType, questGiverEntry);
+            payload = payloadCache.GetQuestPayload(quest, questGiverType, questGiverEntry, localeIndex, protocol);
+        }
+
+        return payload;
+    }
+
+    void VoiceoverModule::ResolveQuestGiver(const Quest* quest, QuestStarterType& questGiverType, uint32& questGiverEntry) const
+    {
+        if (questGiverType == QuestStarterType::NONE)
+        {
+            // Fall back to whoever starts the quest (e.g. shared quests or quest log syncs)
+            questGiverEntry = 0;
+            if (const QuestStarter* questStarter = GetQuestIndex()->GetQuestStarter(quest->GetQuestId()))
+            {
+                questGiverType = questStarter->type;
+                questGiverEntry = questStarter->entry;
+            }
+            else
+            {
+                questGiverType = QuestStarterType::CREATURE;
+            }
+        }
+    }
+
+    void VoiceoverModule::LoadIndexes()
+    {
+        std::shared_ptr<VoiceoverQuestIndex> newQuestIndex = std::make_shared<VoiceoverQuestIndex>();
+        const std::string& snapshotFile = GetConfig()->indexSnapshotFile;
+        if (snapshotFile.empty())
+        {
+            newQuestIndex->Build();
+        }
+        else
+        {
+            // The snapshot is only used if the quest tables are the same it was built from
+            const uint64 contentHash = VoiceoverQuestIndex::GetContentHash();
+            const IndexSnapshotRebuild rebuild = GetConfig()->indexSnapshotRebuild;
+            if (rebuild == IndexSnapshotRebuild::ALWAYS || !newQuestIndex->LoadSnapshot(snapshotFile, contentHash))
+            {
+                newQuestIndex->Build();
+                if (rebuild != IndexSnapshotRebuild::NEVER)
+                {
+                    newQuestIndex->SaveSnapshot(snapshotFile, contentHash);
+                }
+            }
+        }
+
+        std::shared_ptr<VoiceoverGossipIndex> newGossipIndex = std::make_shared<VoiceoverGossipIndex>();
+        if (!GetConfig()->gossipLookupFile.empty())
+        {
+            newGossipIndex->Load(GetConfig()->gossipLookupFile);
+        }
+
+        std::shared_ptr<VoiceoverVoiceManifest> newVoiceManifest = std::make_shared<VoiceoverVoiceManifest>();
+        if (!GetConfig()->voiceManifestFile.empty())
+        {
+            newVoiceManifest->Load(GetConfig()->voiceManifestFile);
+        }
+
+        // The zones only list the quests the voice packs have
+        std::shared_ptr<VoiceoverZoneIndex> newZoneIndex = std::make_shared<VoiceoverZoneIndex>();
+        newZoneIndex->Build(*newQuestIndex, *newVoiceManifest);
+
+        std::atomic_store(&questIndex, std::shared_ptr<const VoiceoverQuestIndex>(std::move(newQuestIndex)));
+        std::atomic_store(&gossipIndex, std::shared_ptr<const VoiceoverGossipIndex>(std::move(newGossipIndex)));
+        std::atomic_store(&voiceManifest, std::shared_ptr<const VoiceoverVoiceManifest>(std::move(newVoiceManifest)));
+        std::atomic_store(&zoneIndex, std::shared_ptr<const VoiceoverZoneIndex>(std::move(newZoneIndex)));
+    }
+
+    void VoiceoverModule::OnAcceptQuest(Player* player, uint32 questId, const ObjectGuid* questGiver)
+    {
+        UpdateQuestLog(player, questId, questGiver, true);
+    }
+
+    void VoiceoverModule::OnAbandonQuest(Player* player, uint32 questId)
+    {
+        UpdateQuestLog(player, questId, nullptr, false);
+    }
+
+    void VoiceoverModule::OnAddQuest(Player* player, uint32 questId)
+    {
+        UpdateQuestLog(player, questId, nullptr, true);
+    }
+
+    void VoiceoverModule::OnRemoveQuest(Player* player, uint32 questId)
+    {
+        UpdateQuestLog(player, questId, nullptr, false);
+    }
+
+    void VoiceoverModule::OnRewardQuest(Player* player, uint32 questId)
+    {
+        UpdateQuestLog(player, questId, nullptr, false);
+    }
+
+    void VoiceoverModule::UpdateQuestLog(Player* player, uint32 questId, const ObjectGuid* questGiver, bool added)
+    {
+        if (GetConfig()->enabled && player)
+        {
+#ifdef ENABLE_PLAYERBOTS
+            // Don't allow bot characters
+            if (!player->isRealPlayer())
+                return;
+#endif
+
+            if (VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+            {
+                QuestLogDelta delta;
+                if (GetVoiceManifest()->IsQuestVoiced(questId) && playerMgr->AddQuestLogDelta(questId, questGiver, added, delta))
+                {
+                    metrics.Add(MetricCounter::QUEST_LOG_DELTAS);
+                    SendQuestLogDelta(player, delta);
+                }
+            }
+        }
+    }
+
+    void VoiceoverModule::SendQuestLogDelta(const Player* player, const QuestLogDelta& delta)
+    {
+        const Quest* quest = sObjectMgr.GetQuestTemplate(delta.questId);
+        if (!quest)
+        {
+            return;
+        }
+
+        // QuestDelta#sequence;status;... and D#sequence;status;... carry the same records as QuestLog# and L#
+        const AddonProtocol protocol = GetAddonProtocol(player);
+        std::string header = protocol == AddonProtocol::V2 ? "L#" : "QuestLog#";
+        if (HasAddonCapability(player, AddonCapability::QUEST_LOG_DELTAS))
+        {
+            header = protocol == AddonProtocol::V2 ? "D#" : "QuestDelta#";
+            if (protocol == AddonProtocol::V2)
+            {
+                AppendBase36(header, delta.sequence);
+            }
+            else
+            {
+                header += std::to_string(delta.sequence);
+            }
+
+            header += ';';
+        }
+
+        if (!delta.added && protocol == AddonProtocol::V2)
+        {
+            // L#0;questId, the addon finds the quest to remove by its id
+            header += "0;";
+            AppendBase36(header, delta.questId);
+            SendAddonMessage(player, header.c_str(), header.size());
+        }
+        else if (const QuestPayload payload = GetQuestPayload(player, quest, delta.questGiver.IsEmpty() ? nullptr : &delta.questGiver))
+        {
+            header += "%u;";
+            SendAddonMessage(player, header.c_str(), delta.added ? 1 : 0, *payload);
+        }
+    }
+
+    void VoiceoverModule::OnSendQuestDetails(Player* player, uint32 questId, const ObjectGuid& questGiver)
+    {
+        PushSoundEvent(player, SoundEvent::QUEST_ACCEPT, questId, questGiver, std::string());
+    }
+
+    void VoiceoverModule::OnSendQuestRequestItems(Player* player, uint32 questId, const ObjectGuid& questGiver)
+    {
+        PushSoundEvent(player, SoundEvent::QUEST_PROGRESS, questId, questGiver, std::string());
+    }
+
+    void VoiceoverModule::OnSendQuestOfferReward(Player* player, uint32 questId, const ObjectGuid& questGiver)
+    {
+        PushSoundEvent(player, SoundEvent::QUEST_COMPLETE, questId, questGiver, std::string());
+    }
+
+    void VoiceoverModule::OnSendQuestGreeting(Player* player, const ObjectGuid& questGiver, const std::string& text)
+    {
+        PushSoundEvent(player, SoundEvent::QUEST_GREETING, 0, questGiver, text);
+    }
+
+    void VoiceoverModule::OnSendGossipMenu(Player* player, const ObjectGuid& gossipGiver, const std::string& text)
+    {
+        PushSoundEvent(player, SoundEvent::GOSSIP, 0, gossipGiver, text);
+    }
+
+    void VoiceoverModule::PushSoundEvent(Player* player, SoundEvent eventType, uint32 questId, const ObjectGuid& giver, const std::string& text)
+    {
+        MarkHookCalled(AddonCapability::SOUND_EVENT_PUSH);
+
+        if (GetConfig()->enabled && player && HasAddonCapability(player, AddonCapability::SOUND_EVENT_PUSH))
+        {
+#ifdef ENABLE_PLAYERBOTS
+            // Don't allow bot characters
+            if (!player->isRealPlayer())
+                return;
+#endif
+
+            if (VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+            {
+                // The core sends some frames more than once (e.g. the quest details after a quest query)
+                const uint32 id = questId ? questId : giver.GetEntry();
+                if (!playerMgr->MarkEventPushed(MakeRequestKey((uint8)eventType, id, text.empty() ? 0 : VoiceoverQuestIndex::HashTitle(text))))
+                {
+                    metrics.Add(MetricCounter::COALESCED_REQUESTS);
+                    return;
+                }
+
+                metrics.Add(MetricCounter::PUSHED_SOUND_EVENTS);
+
+                // Same request the addon would send once the frame is shown, but with the exact quest and giver
+                SoundEventRequest request;
+                request.playerGuid = player->GetObjectGuid();
+                request.eventType = eventType;
+                request.id = questId;
+                request.text = text;
+                request.targetType = GetStarterTypeFromGuid(giver);
+                request.targetEntry = giver.GetEntry();
+                request.localeIndex = player->GetSession()->GetSessionDbLocaleIndex();
+                request.protocol = GetAddonProtocol(player);
+                SubmitSoundEvent(player, std::move(request));
+            }
+        }
+    }
+
+    void VoiceoverModule::SubmitSoundEvent(Player* player, SoundEventRequest&& request)
+    {
+        SoundEventResult result;
+        result.request = std::move(request);
+        if (resolverPool.IsRunning())
+        {
+            // The reply is written and sent from OnUpdate once a worker resolved it
+            resolverPool.Enqueue([this, result = std::move(result)]() mutable
+            {
+                ResolveSoundEvent(result);
+
+                // Requests without a reply are still handed back to finish them
+                if (result.isVoiced || result.request.requestKey != 0)
+                {
+                    completedSoundEvents.Push(std::move(result));
+                }
+            });
+        }
+        else
+        {
+            ResolveSoundEvent(result);
+            SendSoundEvent(player, result);
+        }
+    }
+
+    void VoiceoverModule::SendSoundEvent(Player* player, const SoundEventResult& result)
+    {
+        if (VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+        {
+            playerMgr->FinishRequest(result.request.requestKey);
+        }
+
+        const std::string message = FormatSoundEvent(result);
+        if (!message.empty())
+        {
+            SendAddonMessage(player, message.c_str(), message.size(), AddonMessagePriority::SOUND_EVENT);
+        }
+    }
+
+    // Scratch space reused by every addon message sent from the same thread
+    struct AddonMessageBuffer
+    {
+        char line[ADDON_MESSAGE_BUFFER_SIZE];
+        WorldPacket packet;
+        size_t packetCapacity = 0;
+    };
+
+    thread_local AddonMessageBuffer addonMessageBuffer;
+    std::atomic<uint64> addonMessageAllocations(0);
+
+    void VoiceoverModule::SendAddonMessage(const Player* player, const char* message) const
+    {
+        if (message)
+        {
+            SendAddonMessage(player, message, strlen(message));
+        }
+    }
+
+    void VoiceoverModule::SendAddonMessage(const Player* player, const char* message, size_t length, AddonMessagePriority priority) const
+    {
+        if (const VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+        {
+            VoiceoverOutboundQueue& queue = playerMgr->GetOutboundQueue();
+            const size_t maxLineLength = ADDON_MESSAGE_BUFFER_SIZE - strlen(GetChatCommandPrefix()) - 2;
+
+            // Every line goes out as its own addon message with the prefix in front
+            const char* pos = message;
+            const char* end = message + length;
+            while (pos < end)
+            {
+                const char* lineEnd = (const char*)memchr(pos, '\n', end - pos);
+                if (!lineEnd)
+                {
+                    lineEnd = end;
+                }
+
+                const size_t lineLength = std::min((size_t)(lineEnd - pos), maxLineLength);
+                if (lineLength > 0)
+                {
+                    queue.Push(priority, pos, lineLength);
+                }
+
+                pos = lineEnd + 1;
+            }
+        }
+    }
+
+    void VoiceoverModule::FlushAddonMessages(const Player* player, VoiceoverOutboundQueue& queue) const
+    {
+        VoiceoverOutboundQueue::FlushOptions options;
+        options.maxLength = MAX_ADDON_MESSAGE_LENGTH - strlen(GetChatCommandPrefix()) - 1;
+        options.batch = HasAddonCapability(player, AddonCapability::BATCHED_MESSAGES);
+
+        // A lagging client has its own packets piling up, the quest log sync then only
+        // takes an addon message per update so it doesn't hold back the gameplay packets
+        const uint32 laggingLatency = GetConfig()->laggingClientLatency;
+        if (laggingLatency > 0 && player->GetSession()->GetLatency() >= laggingLatency)
+        {
+            options.questLogBudget = options.maxLength;
+        }
+
+        const VoiceoverOutboundQueue::FlushResult result = queue.Flush(options, [this, player](const char* message, size_t length)
+        {
+            SendAddonPacket(player, message, length);
+        });
+
+        metrics.Add(MetricCounter::BATCHED_MESSAGES, result.messages - result.lines);
+        if (result.heldBack)
+        {
+            metrics.Add(MetricCounter::HELD_BACK_FLUSHES);
+        }
+    }
+
+    void VoiceoverModule::SendAddonPacket(const Player* player, const char* message, size_t length) const
+    {
+        AddonMessageBuffer& buffer = addonMessageBuffer;
+
+        const char* prefix = GetChatCommandPrefix();
+        const size_t prefixLength = strlen(prefix);
+        const size_t lineLength = std::min(length, sizeof(buffer.line) - prefixLength - 2);
+        memcpy(buffer.line, prefix, prefixLength);
+        buffer.line[prefixLength] = '\t';
+        memcpy(buffer.line + prefixLength + 1, message, lineLength);
+        buffer.line[prefixLength + 1 + lineLength] = '\0';
+
+        // The packet keeps its storage between messages, it only grows for longer lines
+        const size_t packetSize = prefixLength + 1 + lineLength + CHAT_PACKET_HEADER_SIZE;
+        if (packetSize > buffer.packetCapacity)
+        {
+            buffer.packetCapacity = std::max(packetSize, (size_t)MAX_ADDON_MESSAGE_LENGTH + CHAT_PACKET_HEADER_SIZE);
+            buffer.packet.reserve(buffer.packetCapacity);
+            ++addonMessageAllocations;
+        }
+
+#if EXPANSION == 0
+        ChatHandler::BuildChatPacket(buffer.packet, CHAT_MSG_ADDON, buffer.line, LANG_ADDON);
+#else
+        ChatHandler::BuildChatPacket(buffer.packet, CHAT_MSG_WHISPER, buffer.line, LANG_ADDON);
+#endif
+        player->GetSession()->SendPacket(buffer.packet);
+        metrics.Add(MetricCounter::PACKETS_SENT);
+        metrics.Add(MetricCounter::BYTES_SENT, buffer.packet.size());
+    }
+
+    void VoiceoverModule::PSendAddonMessage(const Player* player, const char* format, ...) const
+    {
+        if (player)
+        {
+            va_list ap;
+            char str[ADDON_MESSAGE_BUFFER_SIZE];
+            va_start(ap, format);
+            const int length = vsnprintf(str, sizeof(str), format, ap);
+            va_end(ap);
+
+            if (length > 0)
+            {
+                SendAddonMessage(player, str, std::min((size_t)length, sizeof(str) - 1));
+            }
+        }
+    }
+
+    void VoiceoverModule::SendAddonMessage(const Player* player, const char* header, uint8 status, const std::string& payload) const
+    {
+        if (player)
+        {
+            char str[ADDON_MESSAGE_BUFFER_SIZE];
+            const int headerLength = snprintf(str, sizeof(str), header, status);
+            if (headerLength > 0 && (size_t)headerLength < sizeof(str))
+            {
+                // Copy the cached payload as is instead of formatting it again
+                const size_t payloadLength = std::min(payload.size(), sizeof(str) - headerLength - 1);
+                memcpy(str + headerLength, payload.data(), payloadLength);
+
+                SendAddonMessage(player, str, headerLength + payloadLength);
+            }
+        }
+    }
+
+    uint64 VoiceoverModule::GetAddonMessageAllocations() const
+    {
+        return addonMessageAllocations;
+    }
+
+    void VoiceoverModule::SendQuestLogSnapshot(const Player* player, const std::vector<QuestPayload>& payloads, AddonProtocol protocol, uint32 questLogSequence) const
+    {
+        if (player)
+        {
+            // QuestSnapshot#part;parts[;questLogSequence]#record^record^...
+            const char* snapshotName = GetQuestSnapshotName(protocol);
+            char sequence[16] = "";
+            if (questLogSequence)
+            {
+                snprintf(sequence, sizeof(sequence), ";%u", questLogSequence);
+            }
+
+            const size_t headerLength = strlen(GetChatCommandPrefix()) + strlen(snapshotName) + strlen("\t#00;00#") + strlen(sequence);
+            const size_t maxRecordsLength = MAX_ADDON_MESSAGE_LENGTH - headerLength;
+
+            // Records that can't be packed safely are sent on their own
+            auto isPackable = [maxRecordsLength](const QuestPayload& payload)
+            {
+                return payload->size() <= maxRecordsLength && payload->find(QUEST_LOG_SNAPSHOT_SEPARATOR) == std::string::npos && payload->find('\n') == std::string::npos;
+            };
+
+            // Every part carries the number of parts, so they are counted before any is written
+            uint32 partCount = 1;
+            size_t recordsLength = 0;
+            for (const QuestPayload& payload : payloads)
+            {
+                if (isPackable(payload))
+                {
+                    if (recordsLength > 0 && recordsLength + 1 + payload->size() > maxRecordsLength)
+                    {
+                        ++partCount;
+                        recordsLength = 0;
+                    }
+
+                    recordsLength += (recordsLength > 0 ? 1 : 0) + payload->size();
+                }
+            }
+
+            // The parts are packed in place, the cached payloads are only copied once
+            char message[ADDON_MESSAGE_BUFFER_SIZE];
+            uint32 part = 1;
+            size_t recordsStart = snprintf(message, sizeof(message), "%s#%u;%u%s#", snapshotName, part, partCount, sequence);
+            size_t length = recordsStart;
+            for (const QuestPayload& payload : payloads)
+            {
+                if (!isPackable(payload))
+                {
+                    continue;
+                }
+
+                if (length > recordsStart && length - recordsStart + 1 + payload->size() > maxRecordsLength)
+                {
+                    SendAddonMessage(player, message, length);
+                    recordsStart = snprintf(message, sizeof(message), "%s#%u;%u%s#", snapshotName, ++part, partCount, sequence);
+                    length = recordsStart;
+                }
+
+                if (length > recordsStart)
+                {
+                    message[length++] = QUEST_LOG_SNAPSHOT_SEPARATOR;
+                }
+
+                memcpy(message + length, payload->data(), payload->size());
+                length += payload->size();
+            }
+
+            // An empty snapshot is still sent so the client clears its quest log
+            SendAddonMessage(player, message, length);
+
+            // The first snapshot part resets the client quest log, so these go last
+            const uint8 wasAdded = 1;
+            for (const QuestPayload& payload : payloads)
+            {
+                if (!isPackable(payload))
+                {
+                    SendAddonMessage(player, GetQuestLogHeader(protocol), wasAdded, *payload);
+                }
+            }
+        }
+    }
+
+    void VoiceoverModule::SendZoneQuestHints(const Player* player, VoiceoverPlayerMgr* playerMgr)
+    {
+        // Most updates find the player where it was
+        const uint32 zoneId = player->GetZoneId();
+        const uint32 areaId = player->GetAreaId();
+        if (!playerMgr->SetHintLocation(zoneId, areaId))
+        {
+            return;
+        }
+
+        // Quests are sorted under their zone or under the area they are given in
+        const std::shared_ptr<const VoiceoverZoneIndex> zones = GetZoneIndex();
+        const size_t maxLength = MAX_ADDON_MESSAGE_LENGTH - strlen(GetChatCommandPrefix()) - 1;
+        for (const uint32 id : { zoneId, areaId })
+        {
+            if (id == 0 || !zones->HasZone(id) || !playerMgr->MarkZoneHinted(id))
+            {
+                continue;
+            }
+
+            // The addon isn't waiting on the hints, they go out with the quest log messages
+            if (const ZoneQuestHints hints = zones->GetZoneQuestHints(id, player->GetSession()->GetSessionDbLocaleIndex(), maxLength))
+            {
+                for (const std::string& message : *hints)
+                {
+                    SendAddonMessage(player, message.c_str(), message.size());
+                }
+
+                metrics.Add(MetricCounter::ZONE_QUEST_HINTS);
+                metrics.Add(MetricCounter::ZONE_QUEST_HINT_MESSAGES, hints->size());
+            }
+        }
+    }
+
+    void VoiceoverModule::SendCreatureTexts()
+    {
+        creatureTexts.TakePending(creatureTextBatch);
+        if (creatureTextBatch.empty())
+        {
+            return;
+        }
+
+        const std::shared_ptr<const VoiceoverGossipIndex> gossipTexts = GetGossipIndex();
+        const std::shared_ptr<const VoiceoverVoiceManifest> manifest = GetVoiceManifest();
+        for (const CreatureText& creatureText : creatureTextBatch)
+        {
+            // Looked up once however many players hear it
+            const uint32 creatureEntry = creatureText.source.GetEntry();
+            const std::string* hash = gossipTexts->GetGossipHash(QuestStarterType::CREATURE, creatureEntry, creatureText.text);
+            if (!hash || !manifest->IsGossipVoiced(*hash))
+            {
+                metrics.Add(MetricCounter::CREATURE_TEXTS_UNVOICED);
+                continue;
+            }
+
+            // The message only differs by protocol and locale, each one is built for the first listener that needs it.
+            // SoundEvent#6;0;giverGUID;;giverName;soundHash or S#6;0;giver;giverName;soundHash, there is no frame to take the name from.
+            creatureTextMessages.clear();
+            uint32 recipients = 0;
+            creatureTexts.VisitListeners(creatureText.mapKey, [&](const ObjectGuid& listener)
+            {
+                const Player* player = ObjectAccessor::FindPlayer(listener);
+                if (!player || VoiceoverCreatureTexts::MakeMapKey(player->GetMapId(), player->GetInstanceId()) != creatureText.mapKey ||
+                    !creatureText.IsInRange(player->GetPositionX(), player->GetPositionY(), player->GetPositionZ()))
+                {
+                    return;
+                }
+
+                const AddonProtocol protocol = GetAddonProtocol(player);
+                const int localeIndex = player->GetSession()->GetSessionDbLocaleIndex();
+                auto messageIt = std::find_if(creatureTextMessages.begin(), creatureTextMessages.end(), [protocol, localeIndex](const CreatureTextMessage& message)
+                {
+                    return message.protocol == protocol && message.localeIndex == localeIndex;
+                });
+
+                if (messageIt == creatureTextMessages.end())
+                {
+                    CreatureTextMessage message;
+                    message.protocol = protocol;
+                    message.localeIndex = localeIndex;
+                    message.message.append(GetSoundEventName(protocol)).append("#").append(std::to_string((uint32)SoundEvent::CREATURE_TEXT)).append(";0;");
+                    AppendQuestGiver(message.message, protocol, QuestStarterType::CREATURE, creatureEntry);
+                    message.message.append(protocol == AddonProtocol::V2 ? ";" : ";;");
+                    message.message.append(VoiceoverPayloadCache::GetQuestGiverName(QuestStarterType::CREATURE, creatureEntry, localeIndex)).append(";").append(*hash);
+                    messageIt = creatureTextMessages.insert(creatureTextMessages.end(), std::move(message));
+                    metrics.Add(MetricCounter::CREATURE_TEXT_MESSAGES);
+                }
+
+                SendAddonMessage(player, messageIt->message.c_str(), messageIt->message.size(), AddonMessagePriority::SOUND_EVENT);
+                recipients++;
+            });
+
+            metrics.Add(MetricCounter::CREATURE_TEXTS_SENT, recipients);
+        }
+    }
+
+    void VoiceoverModule::ResolveSoundEvent(SoundEventResult& result)
+    {
+        const VoiceoverMetrics::ScopedTimer timer(metrics, MetricTimer::SOUND_EVENT_RESOLVE);
+        const SoundEventRequest& request = result.request;
+
+        const bool isQuestEvent = request.eventType == SoundEvent::QUEST_ACCEPT || request.eventType == SoundEvent::QUEST_PROGRESS || request.eventType == SoundEvent::QUEST_COMPLETE;
+        const bool isGossipEvent = request.eventType == SoundEvent::QUEST_GREETING || request.eventType == SoundEvent::GOSSIP;
+        if (isQuestEvent)
+        {
+            uint32 questId = request.id;
+            MetricCounter resolution = MetricCounter::QUEST_SUPPLIED_ID;
+            if (questId == 0 && request.targetType != QuestStarterType::NONE && !request.text.empty())
+            {
+                // Try to guess the id based on the event type and the current target of the player
+                // The fingerprint of the frame text tells apart the quests of the giver that share the title
+                const QuestRelationType relation = request.eventType == SoundEvent::QUEST_ACCEPT ? QuestRelationType::STARTER : QuestRelationType::ENDER;
+                const TextFingerprint* fingerprint = request.fingerprint.IsEmpty() ? nullptr : &request.fingerprint;
+                uint32 titleMatches = 0;
+                questId = GetQuestIndex()->GetQuestIdByTitle(relation, request.targetType, request.targetEntry, request.localeIndex, request.text, fingerprint, GetQuestTextType(request.eventType), &titleMatches);
+                resolution = MetricCounter::QUEST_TITLE_INDEX;
+                if (fingerprint && titleMatches > 1)
+                {
+                    metrics.Add(MetricCounter::QUEST_TITLE_DISAMBIGUATED);
+                }
+            }
+
+            if (questId == 0)
+            {
+                metrics.Add(MetricCounter::QUEST_UNRESOLVED);
+                return;
+            }
+
+            // Nothing is sent for lines none of the installed voice packs recorded
+            if (!GetVoiceManifest()->IsQuestLineVoiced(GetVoicedQuestLine(request.eventType), questId))
+            {
+                metrics.Add(resolution);
+                metrics.Add(MetricCounter::QUEST_UNVOICED);
+                return;
+            }
+
+            result.isVoiced = true;
+            result.questId = questId;
+            result.questResolution = resolution;
+            result.giverType = request.targetType;
+            result.giverEntry = request.targetEntry;
+        }
+        else if (isGossipEvent)
+        {
+            // The addon sends the giver entry when it knows it, the selected npc is used otherwise
+            result.giverType = QuestStarterType::CREATURE;
+            result.giverEntry = request.id;
+            if (result.giverEntry == 0)
+            {
+                result.giverType = request.targetType;
+                result.giverEntry = request.targetEntry;
+            }
+
+            if (result.giverEntry != 0 && result.giverType != QuestStarterType::NONE)
+            {
+                const std::shared_ptr<const VoiceoverGossipIndex> gossipTexts = GetGossipIndex();
+                const std::string* hash = gossipTexts->GetGossipHash(result.giverType, result.giverEntry, request.text);
+                metrics.Add(hash ? MetricCounter::GOSSIP_RESOLVED : MetricCounter::GOSSIP_UNRESOLVED);
+
+                if (hash && !GetVoiceManifest()->IsGossipVoiced(*hash))
+                {
+                    metrics.Add(MetricCounter::GOSSIP_UNVOICED);
+                    return;
+                }
+
+                // Copied, the gossip index may be replaced before the reply is written
+                if (hash)
+                {
+                    result.hasSoundHash = true;
+                    result.soundHash = *hash;
+                }
+            }
+            else
+            {
+                metrics.Add(MetricCounter::GOSSIP_UNRESOLVED);
+            }
+
+            result.isVoiced = true;
+        }
+    }
+
+    std::string VoiceoverModule::FormatSoundEvent(const SoundEventResult& result)
+    {
+        std::string message;
+        if (!result.isVoiced)
+        {
+            return message;
+        }
+
+        const SoundEventRequest& request = result.request;
+        const std::string eventTypeStr = std::to_string((uint32)request.eventType);
+        if (result.questId != 0)
+        {
+            const Quest* quest = sObjectMgr.GetQuestTemplate(result.questId);
+            metrics.Add(quest ? result.questResolution : MetricCounter::QUEST_UNRESOLVED);
+
+            if (quest && request.protocol == AddonProtocol::V2)
+            {
+                // S#eventType;questId;giver[;giverName]. The addon takes the title from the quest frame
+                // and so the name of creatures and gameobjects, item names are the only ones sent.
+                QuestStarterType giverType = result.giverType;
+                uint32 giverEntry = result.giverEntry;
+                ResolveQuestGiver(quest, giverType, giverEntry);
+
+                message.append("S#").append(eventTypeStr).append(";");
+                AppendBase36(message, result.questId);
+                message.append(";");
+                AppendQuestGiver(message, request.protocol, giverType, giverEntry);
+                if (giverType == QuestStarterType::ITEM)
+                {
+                    message.append(";").append(VoiceoverPayloadCache::GetQuestGiverName(giverType, giverEntry, request.localeIndex));
+                }
+            }
+            else if (quest)
+            {
+                if (const QuestPayload payload = GetQuestPayload(quest, result.giverType, result.giverEntry, request.localeIndex, request.protocol))
+                {
+                    // SoundEvent#eventType;questId;giverGUID;questTitle;giverName
+                    message.reserve(eventTypeStr.size() + payload->size() + 12);
+                    message.append("SoundEvent#").append(eventTypeStr).append(";").append(*payload);
+                }
+            }
+        }
+        else
+        {
+            // SoundEvent#eventType;0;giverGUID;;giverName;soundHash
+            // An empty hash (no lookup table or no match) makes the addon search the text itself.
+            // V2 sends S#eventType;0[;giver;;soundHash] and the addon takes the name from the gossip frame.
+            const bool isCompact = request.protocol == AddonProtocol::V2;
+            message.append(GetSoundEventName(request.protocol)).append("#").append(eventTypeStr).append(";0");
+            if (result.giverEntry != 0 && result.giverType != QuestStarterType::NONE)
+            {
+                message.append(";");
+                AppendQuestGiver(message, request.protocol, result.giverType, result.giverEntry);
+                if (!isCompact)
+                {
+                    message.append(";;").append(VoiceoverPayloadCache::GetQuestGiverName(result.giverType, result.giverEntry, request.localeIndex)).append(";");
+                    message.append(result.soundHash);
+                }
+                else if (result.hasSoundHash)
+                {
+                    message.append(";;").append(result.soundHash);
+                }
+            }
+            else if (!isCompact)
+            {
+                message.append(";;;;");
+            }
+        }
+
+        return message;
+    }
+
+    std::vector<ModuleChatCommand>* VoiceoverModule::GetCommandTable()
+    {
+        static std::vector<ModuleChatCommand> commandTable =
+        {
+            { "enableAddon", std::bind(&VoiceoverModule::HandleEnableAddon, this, std::placeholders::_1, std::placeholders::_2), SEC_PLAYER },
+            { "questLog", std::bind(&VoiceoverModule::HandleQuestLogRequest, this, std::placeholders::_1, std::placeholders::_2), SEC_PLAYER },
+            { "soundEvent", std::bind(&VoiceoverModule::HandleSoundEventRequest, this, std::placeholders::_1, std::placeholders::_2), SEC_PLAYER },
+            { "reload", std::bind(&VoiceoverModule::HandleReloadRequest, this, std::placeholders::_1, std::placeholders::_2), SEC_ADMINISTRATOR },
+            { "stats", std::bind(&VoiceoverModule::HandleStatsRequest, this, std::placeholders::_1, std::placeholders::_2), SEC_GAMEMASTER },
+            { "trace", std::bind(&VoiceoverModule::HandleTraceRequest, this, std::placeholders::_1, std::placeholders::_2), SEC_ADMINISTRATOR }
+        };
+
+        return &commandTable;
+    }
+
+    bool VoiceoverModule::HandleEnableAddon(WorldSession* session, const std::string& args)
+    {
+        return session && HandleAddonCommand(session->GetPlayer(), AddonCommand::ENABLE_ADDON, args);
+    }
+
+    bool VoiceoverModule::HandleQuestLogRequest(WorldSession* session, const std::string& args)
+    {
+        return session && HandleAddonCommand(session->GetPlayer(), AddonCommand::QUEST_LOG, args);
+    }
+
+    bool VoiceoverModule::HandleSoundEventRequest(WorldSession* session, const std::string& args)
+    {
+        return session && HandleAddonCommand(session->GetPlayer(), AddonCommand::SOUND_EVENT, args);
+    }
+
+    bool VoiceoverModule::OnHandleChatMessage(Player* player, uint32 type, const std::string& message)
+    {
+        MarkHookCalled(AddonCapability::ADDON_CHANNEL);
+
+        if (!GetConfig()->enabled || !GetConfig()->addonChannel || !player || type != CHAT_MSG_WHISPER)
+        {
+            return false;
+        }
+
+        const std::string_view prefix = GetChatCommandPrefix();
+        if (message.size() <= prefix.size() || message.compare(0, prefix.size(), prefix) != 0 || message[prefix.size()] != '\t')
+        {
+            return false;
+        }
+
+        std::string_view args;
+        const AddonCommand command = ParseAddonRequest(std::string_view(message).substr(prefix.size() + 1), args);
+        if (command != AddonCommand::NONE)
+        {
+            metrics.Add(MetricCounter::ADDON_CHANNEL_REQUESTS);
+            HandleAddonCommand(player, command, args);
+        }
+
+        // Requests of a newer addon the module doesn't know are dropped as well, nobody is meant to read them
+        return true;
+    }
+
+    void VoiceoverModule::OnCreatureChat(const Creature* creature, uint32 chatType, const std::string& text)
+    {
+        MarkHookCalled(AddonCapability::CREATURE_TEXTS);
+
+        if (!GetConfig()->enabled || !GetConfig()->creatureTexts || !creature || text.empty())
+        {
+            return;
+        }
+
+        if (chatType != CHAT_MSG_MONSTER_SAY && chatType != CHAT_MSG_MONSTER_YELL)
+        {
+            return;
+        }
+
+        // Most lines are said where nobody uses the addon, those are dropped right away
+        const uint64 mapKey = VoiceoverCreatureTexts::MakeMapKey(creature->GetMapId(), creature->GetInstanceId());
+        if (!creatureTexts.HasListeners(mapKey))
+        {
+            return;
+        }
+
+        CreatureText creatureText;
+        creatureText.source = creature->GetObjectGuid();
+        creatureText.mapKey = mapKey;
+        creatureText.x = creature->GetPositionX();
+        creatureText.y = creature->GetPositionY();
+        creatureText.z = creature->GetPositionZ();
+        creatureText.range = sWorld.getConfig(chatType == CHAT_MSG_MONSTER_YELL ? CONFIG_FLOAT_LISTEN_RANGE_YELL : CONFIG_FLOAT_LISTEN_RANGE_SAY);
+        creatureText.text = text;
+        creatureTexts.Push(std::move(creatureText));
+        metrics.Add(MetricCounter::CREATURE_TEXTS_HEARD);
+    }
+
+    constexpr VoiceoverModule::AddonCommandHandler VoiceoverModule::addonCommandHandlers[(uint8)AddonCommand::MAX] =
+    {
+        { MetricTimer::MAX, MetricCounter::MAX, nullptr },
+        { MetricTimer::ENABLE_ADDON, MetricCounter::ENABLE_ADDON_CALLS, &VoiceoverModule::ProcessEnableAddon },
+        { MetricTimer::QUEST_LOG, MetricCounter::QUEST_LOG_CALLS, &VoiceoverModule::ProcessQuestLogRequest },
+        { MetricTimer::SOUND_EVENT, MetricCounter::SOUND_EVENT_CALLS, &VoiceoverModule::ProcessSoundEventRequest }
+    };
+
+    bool VoiceoverModule::HandleAddonCommand(Player* player, AddonCommand command, std::string_view args)
+    {
+        const AddonCommandHandler& handler = addonCommandHandlers[(uint8)command];
+        if (GetConfig()->enabled && player && handler.function)
+        {
+            const VoiceoverMetrics::ScopedTimer timer(metrics, handler.timer);
+            metrics.Add(handler.calls);
+
+#ifdef ENABLE_PLAYERBOTS
+            // Don't allow bot characters
+            if (!player->isRealPlayer())
+                return false;
+#endif
+
+            traceRecorder.Record(command, player, args);
+            return (this->*handler.function)(player, args);
+        }
+
+        return false;
+    }
+
+    bool VoiceoverModule::ProcessEnableAddon(Player* player, std::string_view args)
+    {
+        const EnableAddonArgs arguments = ParseEnableAddonArgs(args);
+        uint32 capabilities = arguments.capabilities & GetSupportedCapabilities();
+
+        // The deltas are numbered from the snapshot the addon got, they don't work without one
+        if ((capabilities & (uint32)AddonCapability::QUEST_LOG_SNAPSHOT) == 0)
+        {
+            capabilities &= ~(uint32)AddonCapability::QUEST_LOG_DELTAS;
+        }
+
+        // The zone quest hints only exist in protocol v2
+        if ((capabilities & (uint32)AddonCapability::COMPACT_PROTOCOL) == 0)
+        {
+            capabilities &= ~(uint32)AddonCapability::ZONE_QUEST_HINTS;
+        }
+
+        // The player manager only exists for players using the addon. The first handshake of the session
+        // creates it with the state of the last one, which lets it skip the quest log sync.
+        const uint32 playerId = player->GetObjectGuid().GetCounter();
+        VoiceoverPlayerMgr* playerMgr = playerMgrs.Find(playerId);
+        if (!playerMgr)
+        {
+            playerMgr = playerMgrs.Insert(playerId, player, this);
+            LoadPlayerState(player, playerMgr);
+        }
+
+        // The addon handshakes once per loaded addon, only the first one gets a reply and changes the state
+        if (!AcceptRequest(playerMgr, MakeRequestKey(REQUEST_ENABLE_ADDON, capabilities, arguments.questLogHash), RequestDedupe::WINDOW))
+        {
+            return true;
+        }
+
+        playerMgr->SetCapabilities(capabilities);
+        playerMgr->SetAddonEnabled(true);
+
+        // The player updates move the listener along when the player changes maps
+        if (capabilities & (uint32)AddonCapability::CREATURE_TEXTS)
+        {
+            const uint64 mapKey = VoiceoverCreatureTexts::MakeMapKey(player->GetMapId(), player->GetInstanceId());
+            creatureTexts.AddListener(player->GetObjectGuid(), mapKey);
+            playerMgr->SetListenerMapKey(mapKey);
+        }
+        else
+        {
+            creatureTexts.RemoveListener(player->GetObjectGuid());
+        }
+
+        // A new handshake is a new addon session, it gets the hints of the zone it is in again
+        playerMgr->ResetZoneQuestHints();
+
+        // After a UI reload the addon only missed the quest log changes since the last one it got
+        std::vector<QuestLogDelta> deltas;
+        if ((capabilities & (uint32)AddonCapability::QUEST_LOG_DELTAS) && arguments.hasQuestLogSequence && playerMgr->GetQuestLogDeltas(arguments.questLogSequence, deltas))
+        {
+            metrics.Add(MetricCounter::QUEST_LOG_CATCH_UPS);
+            PSendAddonMessage(player, "AddonEnabled#%u;1;%u", capabilities, arguments.questLogSequence);
+            for (const QuestLogDelta& delta : deltas)
+            {
+                SendQuestLogDelta(player, delta);
+            }
+
+            return true;
+        }
+
+        // Otherwise the changes are sent from the current quest log on, the addon asks for it if it isn't in sync
+        const uint32 questLogSequence = playerMgr->ResetQuestLog(GetVoicedQuestLog(player));
+
+        if (arguments.hasQuestLogHash || (capabilities & (uint32)AddonCapability::QUEST_LOG_DELTAS))
+        {
+            // The addon kept its quest log from the last session. It can skip the sync if that
+            // session kept it up to date and the quest log didn't change since (e.g. on another client).
+            const uint32 questLogHash = GetQuestLogHash(player);
+            const bool inSync = arguments.hasQuestLogHash && arguments.questLogHash == questLogHash && playerMgr->GetSavedQuestLogHash() == questLogHash;
+            if (capabilities & (uint32)AddonCapability::QUEST_LOG_DELTAS)
+            {
+                PSendAddonMessage(player, "AddonEnabled#%u;%u;%u", capabilities, inSync ? 1 : 0, questLogSequence);
+            }
+            else
+            {
+                PSendAddonMessage(player, "AddonEnabled#%u;%u", capabilities, inSync ? 1 : 0);
+            }
+        }
+        else if (capabilities)
+        {
+            PSendAddonMessage(player, "AddonEnabled#%u", capabilities);
+        }
+        else
+        {
+            SendAddonMessage(player, "AddonEnabled");
+        }
+
+        return true;
+    }
+
+    bool VoiceoverModule::ProcessQuestLogRequest(Player* player, std::string_view args)
+    {
+        if (VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+        {
+            // "questLog" sends the whole quest log, "questLog sequence" only the changes after that one if they are still kept
+            const bool hasDeltas = HasAddonCapability(player, AddonCapability::QUEST_LOG_DELTAS);
+            const QuestLogArgs arguments = ParseQuestLogArgs(args);
+            const bool hasSequence = hasDeltas && arguments.hasSequence;
+            const uint32 sinceSequence = hasSequence ? arguments.sinceSequence : 0;
+            // It is answered right away, a second request is the addon asking again
+            if (AcceptRequest(playerMgr, MakeRequestKey(REQUEST_QUEST_LOG, 0, sinceSequence), RequestDedupe::NONE))
+            {
+                std::vector<QuestLogDelta> deltas;
+                if (hasSequence && playerMgr->GetQuestLogDeltas(sinceSequence, deltas))
+                {
+                    metrics.Add(MetricCounter::QUEST_LOG_CATCH_UPS);
+                    for (const QuestLogDelta& delta : deltas)
+                    {
+                        SendQuestLogDelta(player, delta);
+                    }
+
+                    return true;
+                }
+
+                metrics.Add(MetricCounter::QUEST_LOG_RESYNCS);
+
+                // Quests without voiceovers are left out, the addon has nothing to play for them
+                const std::vector<uint32> questIds = GetVoicedQuestLog(player);
+                std::vector<QuestPayload> payloads;
+                payloads.reserve(questIds.size());
+                for (const uint32 questId : questIds)
+                {
+                    if (QuestPayload payload = GetQuestPayload(player, sObjectMgr.GetQuestTemplate(questId)))
+                    {
+                        payloads.push_back(std::move(payload));
+                    }
+                }
+
+                const uint32 questLogSequence = playerMgr->ResetQuestLog(questIds);
+                const AddonProtocol protocol = GetAddonProtocol(player);
+                if (HasAddonCapability(player, AddonCapability::QUEST_LOG_SNAPSHOT))
+                {
+                    SendQuestLogSnapshot(player, payloads, protocol, hasDeltas ? questLogSequence : 0);
+                }
+                else
+                {
+                    const uint8 wasAdded = 1;
+                    for (const QuestPayload& payload : payloads)
+                    {
+                        SendAddonMessage(player, GetQuestLogHeader(protocol), wasAdded, *payload);
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool VoiceoverModule::ProcessSoundEventRequest(Player* player, std::string_view args)
+    {
+        if (VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+        {
+            SoundEventArgs arguments;
+            if (ParseSoundEventArgs(args, arguments))
+            {
+                const SoundEvent eventType = arguments.eventType >= (uint8)SoundEvent::QUEST_ACCEPT && arguments.eventType <= (uint8)SoundEvent::GOSSIP ? static_cast<SoundEvent>(arguments.eventType) : SoundEvent::INVALID;
+                const uint32 id = arguments.id;
+
+                const bool isQuestEvent = eventType == SoundEvent::QUEST_ACCEPT || eventType == SoundEvent::QUEST_PROGRESS || eventType == SoundEvent::QUEST_COMPLETE;
+
+                // The quest titles come after the fingerprint of the frame text for the addons that send it
+                QuestTitleArgs questTitle;
+                if (isQuestEvent && playerMgr->HasCapability(AddonCapability::QUEST_TEXT_FINGERPRINTS))
+                {
+                    questTitle = ParseQuestTitleArgs(arguments.text);
+                    arguments.text = questTitle.title;
+                }
+
+                // The frame opened again gets its voiceover again, only the copies of a request still being resolved are dropped
+                const uint64 requestKey = MakeRequestKey((uint8)eventType, id, VoiceoverQuestIndex::HashTitle(arguments.text.data(), arguments.text.size()));
+                if (eventType != SoundEvent::INVALID && AcceptRequest(playerMgr, requestKey, RequestDedupe::IN_FLIGHT))
+                {
+                    SoundEventRequest request;
+                    request.requestKey = requestKey;
+                    request.playerGuid = player->GetObjectGuid();
+                    request.eventType = eventType;
+                    request.id = id;
+                    request.text = arguments.text;
+                    ParseTextFingerprint(questTitle.fingerprint, request.fingerprint);
+                    request.localeIndex = player->GetSession()->GetSessionDbLocaleIndex();
+                    request.protocol = GetAddonProtocol(player);
+
+                    const ObjectGuid& targetGuid = player->GetSelectionGuid();
+                    if (!targetGuid.IsEmpty())
+                    {
+                        request.targetType = GetStarterTypeFromGuid(targetGuid);
+                        request.targetEntry = targetGuid.GetEntry();
+                    }
+
+                    SubmitSoundEvent(player, std::move(request));
+                }
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool VoiceoverModule::HandleReloadRequest(WorldSession* session, const std::string& args)
+    {
+        if (GetConfig()->enabled)
+        {
+            // The core doesn't notify modules about .reload of the quest or locale tables,
+            // so this must be run afterwards to drop the data derived from them
+            const size_t cachedBytes = payloadCache.GetMemoryUsage();
+            LoadIndexes();
+            payloadCache.Clear();
+
+            if (session)
+            {
+                const std::shared_ptr<const VoiceoverVoiceManifest> manifest = GetVoiceManifest();
+                ChatHandler(session).PSendSysMessage("Voiceover quest data reloaded (%u bytes of cached payloads released, %u gossip texts, %u voiced quest lines, %u voiced gossip lines, %u zones with voiced quests)",
+                    (uint32)cachedBytes, (uint32)GetGossipIndex()->GetGossipTextCount(), (uint32)manifest->GetQuestLineCount(), (uint32)manifest->GetGossipLineCount(), (uint32)GetZoneIndex()->GetZoneCount());
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool VoiceoverModule::HandleStatsRequest(WorldSession* session, const std::string& args)
+    {
+        if (GetConfig()->enabled)
+        {
+            for (const std::string& line : FormatStats())
+            {
+                if (session)
+                {
+                    ChatHandler(session).SendSysMessage(line.c_str());
+                }
+                else
+                {
+                    sLog.outString("%s", line.c_str());
+                }
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool VoiceoverModule::HandleTraceRequest(WorldSession* session, const std::string& args)
+    {
+        if (GetConfig()->enabled)
+        {
+            // "trace fileName" starts recording the addon commands to the file, "trace" alone stops it
+            std::string message;
+            const std::string& traceDirectory = GetConfig()->traceDirectory;
+            if (!args.empty() && traceDirectory.empty())
+            {
+                message = "Voiceover: set Voiceover.TraceDirectory to record traces";
+            }
+            else if (!args.empty() && !IsValidTraceFileName(args))
+            {
+                message = "Voiceover: the trace file must be a file name without a directory";
+            }
+            else if (!args.empty())
+            {
+                // The file is truncated, so it can only be one inside of the trace directory
+                const std::string tracePath = traceDirectory + "/" + args;
+                message = traceRecorder.Start(tracePath) ? "Voiceover: recording addon commands to " + tracePath : "Voiceover: can't open trace file " + tracePath;
+            }
+            else if (traceRecorder.IsRecording())
+            {
+                message = "Voiceover: trace stopped after " + std::to_string(traceRecorder.Stop()) + " addon commands";
+            }
+            else
+            {
+                message = "Voiceover: no trace is being recorded";
+            }
+
+            if (session)
+            {
+                ChatHandler(session).SendSysMessage(message.c_str());
+            }
+            else
+            {
+                sLog.outString("%s", message.c_str());
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool VoiceoverModule::IsValidTraceFileName(const std::string& fileName)
+    {
+        return !fileName.empty() && fileName.find_first_of("/\\:") == std::string::npos && fileName.find("..") == std::string::npos;
+    }
+
+    std::vector<std::string> VoiceoverModule::FormatStats() const
+    {
+        const VoiceoverMetrics::Snapshot snapshot = metrics.GetSnapshot();
+
+        char line[256];
+        std::vector<std::string> lines;
+        snprintf(line, sizeof(line), "Active addon users: %u, packets sent: %llu (%llu bytes), sound events pushed: %llu, requests coalesced: %llu, rate limited: %llu",
+            GetActiveAddonUsers(),
+            (unsigned long long)snapshot.Get(MetricCounter::PACKETS_SENT),
+            (unsigned long long)snapshot.Get(MetricCounter::BYTES_SENT),
+            (unsigned long long)snapshot.Get(MetricCounter::PUSHED_SOUND_EVENTS),
+            (unsigned long long)snapshot.Get(MetricCounter::COALESCED_REQUESTS),
+            (unsigned long long)snapshot.Get(MetricCounter::RATE_LIMITED_REQUESTS));
+        lines.push_back(line);
+
+        snprintf(line, sizeof(line), "Requests received over the addon channel: %llu of %llu",
+            (unsigned long long)snapshot.Get(MetricCounter::ADDON_CHANNEL_REQUESTS),
+            (unsigned long long)(snapshot.Get(MetricCounter::ENABLE_ADDON_CALLS) + snapshot.Get(MetricCounter::QUEST_LOG_CALLS) + snapshot.Get(MetricCounter::SOUND_EVENT_CALLS)));
+        lines.push_back(line);
+
+        snprintf(line, sizeof(line), "Messages batched with others: %llu, flushes holding back the quest log of a lagging client: %llu",
+            (unsigned long long)snapshot.Get(MetricCounter::BATCHED_MESSAGES),
+            (unsigned long long)snapshot.Get(MetricCounter::HELD_BACK_FLUSHES));
+        lines.push_back(line);
+
+        snprintf(line, sizeof(line), "Quest log changes sent: %llu, caught up from kept changes: %llu, full quest logs sent: %llu",
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_LOG_DELTAS),
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_LOG_CATCH_UPS),
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_LOG_RESYNCS));
+        lines.push_back(line);
+
+        snprintf(line, sizeof(line), "Quest sound events by supplied id: %llu, by title: %llu (%llu told apart by text), unresolved: %llu, unvoiced: %llu. Gossip resolved: %llu, unresolved: %llu, unvoiced: %llu",
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_SUPPLIED_ID),
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_TITLE_INDEX),
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_TITLE_DISAMBIGUATED),
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_UNRESOLVED),
+            (unsigned long long)snapshot.Get(MetricCounter::QUEST_UNVOICED),
+            (unsigned long long)snapshot.Get(MetricCounter::GOSSIP_RESOLVED),
+            (unsigned long long)snapshot.Get(MetricCounter::GOSSIP_UNRESOLVED),
+            (unsigned long long)snapshot.Get(MetricCounter::GOSSIP_UNVOICED));
+        lines.push_back(line);
+
+        snprintf(line, sizeof(line), "Creature texts heard near addon users: %llu, unvoiced: %llu, sent %llu times from %llu built messages",
+            (unsigned long long)snapshot.Get(MetricCounter::CREATURE_TEXTS_HEARD),
+            (unsigned long long)snapshot.Get(MetricCounter::CREATURE_TEXTS_UNVOICED),
+            (unsigned long long)snapshot.Get(MetricCounter::CREATURE_TEXTS_SENT),
+            (unsigned long long)snapshot.Get(MetricCounter::CREATURE_TEXT_MESSAGES));
+        lines.push_back(line);
+
+        snprintf(line, sizeof(line), "Zone quest hints sent: %llu (%llu addon messages)",
+            (unsigned long long)snapshot.Get(MetricCounter::ZONE_QUEST_HINTS),
+            (unsigned long long)snapshot.Get(MetricCounter::ZONE_QUEST_HINT_MESSAGES));
+        lines.push_back(line);
+
+        const std::pair<const char*, MetricTimer> timers[] =
+        {
+            { "enableAddon", MetricTimer::ENABLE_ADDON },
+            { "questLog", MetricTimer::QUEST_LOG },
+            { "soundEvent", MetricTimer::SOUND_EVENT },
+            { "soundEvent (resolve)", MetricTimer::SOUND_EVENT_RESOLVE }
+        };
+
+        const MetricCounter calls[] = { MetricCounter::ENABLE_ADDON_CALLS, MetricCounter::QUEST_LOG_CALLS, MetricCounter::SOUND_EVENT_CALLS, MetricCounter::SOUND_EVENT_CALLS };
+        for (uint8 i = 0; i < sizeof(timers) / sizeof(timers[0]); ++i)
+        {
+            const VoiceoverMetrics::Histogram& histogram = snapshot.Get(timers[i].second);
+            snprintf(line, sizeof(line), "%s: %llu calls, avg %llu us, p50 < %llu us, p99 < %llu us",
+                timers[i].first,
+                (unsigned long long)(timers[i].second == MetricTimer::SOUND_EVENT_RESOLVE ? histogram.count : snapshot.Get(calls[i])),
+                (unsigned long long)histogram.GetAverage(),
+                (unsigned long long)histogram.GetPercentile(50),
+                (unsigned long long)histogram.GetPercentile(99));
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+
+    uint32 VoiceoverModule::GetActiveAddonUsers() const
+    {
+        uint32 activeUsers = 0;
+        playerMgrs.ForEach([&activeUsers](const VoiceoverPlayerMgr& playerMgr)
+        {
+            if (playerMgr.IsAddonEnabled())
+            {
+                activeUsers++;
+            }
+        });
+
+        return activeUsers;
+    }
+
+    VoiceoverPlayerMgr* VoiceoverModule::GetVoiceoverPlayerMgr(Player* player)
+    {
+        if (GetConfig()->enabled && player)
+        {
+            const uint32 playerId = player->GetObjectGuid().GetCounter();
+            VoiceoverPlayerMgr* playerMgr = playerMgrs.Find(playerId);
+            return playerMgr && playerMgr->IsAddonEnabled() ? playerMgr : nullptr;
+        }
+
+        return nullptr;
+    }
+
+    const VoiceoverPlayerMgr* VoiceoverModule::GetVoiceoverPlayerMgr(const Player* player) const
+    {
+        if (GetConfig()->enabled && player)
+        {
+            const uint32 playerId = player->GetObjectGuid().GetCounter();
+            VoiceoverPlayerMgr* playerMgr = playerMgrs.Find(playerId);
+            return playerMgr && playerMgr->IsAddonEnabled() ? playerMgr : nullptr;
+        }
+
+        return nullptr;
+    }
+
+    bool VoiceoverModule::IsAddonEnabled(const Player* player) const
+    {
+        return GetVoiceoverPlayerMgr(player) != nullptr;
+    }
+
+    bool VoiceoverModule::HasAddonCapability(const Player* player, AddonCapability capability) const
+    {
+        if (player)
+        {
+            if (const VoiceoverPlayerMgr* playerMgr = GetVoiceoverPlayerMgr(player))
+            {
+                return playerMgr->HasCapability(capability);
+            }
+        }
+
+        return false;
+    }
+
+    AddonProtocol VoiceoverModule::GetAddonProtocol(const Player* player) const
+    {
+        return HasAddonCapability(player, AddonCapability::COMPACT_PROTOCOL) ? AddonProtocol::V2 : AddonProtocol::V1;
+    }
+
+    uint32 VoiceoverModule::GetSupportedCapabilities() const
+    {
+        uint32 capabilities = (uint32)AddonCapability::ALL;
+        // The addon stops requesting the sound events once it can expect them to be pushed
+        if (!GetConfig()->pushSoundEvents || !(calledHookCapabilities & (uint32)AddonCapability::SOUND_EVENT_PUSH))
+        {
+            capabilities &= ~(uint32)AddonCapability::SOUND_EVENT_PUSH;
+        }
+
+        // The whispers would reach the player instead of the module on a core that doesn't call the chat hook
+        if (!GetConfig()->addonChannel || !(calledHookCapabilities & (uint32)AddonCapability::ADDON_CHANNEL))
+        {
+            capabilities &= ~(uint32)AddonCapability::ADDON_CHANNEL;
+        }
+
+        // Without the creature chat hook the players would be kept as listeners for nothing
+        if (!GetConfig()->creatureTexts || !(calledHookCapabilities & (uint32)AddonCapability::CREATURE_TEXTS))
+        {
+            capabilities &= ~(uint32)AddonCapability::CREATURE_TEXTS;
+        }
+
+        if (!GetConfig()->zoneQuestHints)
+        {
+            capabilities &= ~(uint32)AddonCapability::ZONE_QUEST_HINTS;
+        }
+
+        return capabilities;
+    }
+
+    void VoiceoverModule::MarkHookCalled(AddonCapability capability)
+    {
+        // Read first, the hooks run for every dialog and only the first call has to write
+        if (!(calledHookCapabilities.load(std::memory_order_relaxed) & (uint32)capability))
+        {
+            calledHookCapabilities |= (uint32)capability;
+        }
+    }
+
+    bool VoiceoverModule::AcceptRequest(VoiceoverPlayerMgr* playerMgr, uint64 requestKey, RequestDedupe dedupe)
+    {
+        switch (playerMgr->CheckRequest(requestKey, dedupe))
+        {
+            case RequestResult::COALESCED:
+            {
+                metrics.Add(MetricCounter::COALESCED_REQUESTS);
+                return false;
+            }
+
+            case RequestResult::RATE_LIMITED:
+            {
+                metrics.Add(MetricCounter::RATE_LIMITED_REQUESTS);
+                return false;
+            }
+
+            default: return true;
+        }
     }
 }
\ No newline at end of file
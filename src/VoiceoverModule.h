@@ -3,6 +3,21 @@
 
 #include "Module.h"
 #include "VoiceoverModuleConfig.h"
+#include "VoiceoverAddonCommand.h"
+#include "VoiceoverCompletionQueue.h"
+#include "VoiceoverCreatureTexts.h"
+#include "VoiceoverGossipIndex.h"
+#include "VoiceoverMetrics.h"
+#include "VoiceoverOutboundQueue.h"
+#include "VoiceoverPayloadCache.h"
+#include "VoiceoverPlayerStore.h"
+#include "VoiceoverQuestIndex.h"
+#include "VoiceoverTrace.h"
+#include "VoiceoverVoiceManifest.h"
+#include "VoiceoverWorkerPool.h"
+#include "VoiceoverZoneIndex.h"
+
+#include "Entities/ObjectGuid.h"
 
 namespace cmangos_module
 {
@@ -13,7 +28,93 @@ namespace cmangos_module
         QUEST_COMPLETE = 3,
         QUEST_GREETING = 4,
         GOSSIP = 5,
-        INVALID = 6
+        // Say and yell lines of creatures, only pushed by the server
+        CREATURE_TEXT = 6,
+        INVALID = 7
+    };
+
+    // Optional protocol features the addon can request in the enableAddon handshake
+    enum class AddonCapability : uint32
+    {
+        NONE = 0x00,
+        QUEST_LOG_SNAPSHOT = 0x01,
+        COMPACT_PROTOCOL = 0x02,
+        SOUND_EVENT_PUSH = 0x04,
+        QUEST_LOG_DELTAS = 0x08,
+        ADDON_CHANNEL = 0x10,
+        BATCHED_MESSAGES = 0x20,
+        CREATURE_TEXTS = 0x40,
+        ZONE_QUEST_HINTS = 0x80,
+        QUEST_TEXT_FINGERPRINTS = 0x100,
+        ALL = QUEST_LOG_SNAPSHOT | COMPACT_PROTOCOL | SOUND_EVENT_PUSH | QUEST_LOG_DELTAS | ADDON_CHANNEL | BATCHED_MESSAGES | CREATURE_TEXTS | ZONE_QUEST_HINTS | QUEST_TEXT_FINGERPRINTS
+    };
+
+    // How repeated addon requests are told apart from new ones
+    enum class RequestDedupe : uint8
+    {
+        // Only rate limited, every request is answered
+        NONE,
+        // Ignored within the dedupe window, for the handshakes sent once per loaded addon. Not rate limited.
+        WINDOW,
+        // Ignored while an identical one is still being resolved, it gets the same reply
+        IN_FLIGHT
+    };
+
+    enum class RequestResult : uint8
+    {
+        ACCEPTED,
+        COALESCED,
+        RATE_LIMITED
+    };
+
+    // Everything a sound event needs from the player, taken when the request arrives
+    // so it can be resolved away from the world thread
+    struct SoundEventRequest
+    {
+        ObjectGuid playerGuid;
+        SoundEvent eventType = SoundEvent::INVALID;
+        uint32 id = 0;
+        std::string text;
+        // Of the quest frame text, empty when the addon didn't send one
+        TextFingerprint fingerprint;
+        QuestStarterType targetType = QuestStarterType::NONE;
+        uint32 targetEntry = 0;
+        int localeIndex = -1;
+        AddonProtocol protocol = AddonProtocol::V1;
+        // Of the addon request, 0 for the pushed events
+        uint64 requestKey = 0;
+    };
+
+    // What the indexes tell about a sound event. The reply is written from it on the world thread,
+    // as it takes the quest titles and giver names from the core tables a .reload can replace.
+    struct SoundEventResult
+    {
+        SoundEventRequest request;
+        // False when there is nothing to send (e.g. no voice pack recorded the line)
+        bool isVoiced = false;
+        uint32 questId = 0;
+        MetricCounter questResolution = MetricCounter::QUEST_SUPPLIED_ID;
+        QuestStarterType giverType = QuestStarterType::NONE;
+        uint32 giverEntry = 0;
+        bool hasSoundHash = false;
+        std::string soundHash;
+    };
+
+    // A creature text as sent to the listeners using one protocol and locale
+    struct CreatureTextMessage
+    {
+        AddonProtocol protocol = AddonProtocol::V1;
+        int localeIndex = -1;
+        std::string message;
+    };
+
+    // A quest entering or leaving the quest log, numbered in the order the addon was told about them
+    struct QuestLogDelta
+    {
+        uint32 sequence = 0;
+        uint32 questId = 0;
+        ObjectGuid questGiver;
+        bool added = false;
     };
 
     class VoiceoverModule;
@@ -24,47 +125,282 @@ namespace cmangos_module
         explicit VoiceoverPlayerMgr(Player* inPlayer, VoiceoverModule* inModule);
         ~VoiceoverPlayerMgr() {}
 
-        void EnableAddon() { addonEnabled = true; }
+        void SetCapabilities(uint32 inCapabilities) { capabilities = inCapabilities; }
+        uint32 GetCapabilities() const { return capabilities; }
+        bool HasCapability(AddonCapability capability) const { return (capabilities & (uint32)capability) != 0; }
+
+        // Set by the accepted handshakes, only the sessions that used the addon are saved
+        void SetAddonEnabled(bool enabled) { addonEnabled = enabled; }
         bool IsAddonEnabled() const { return addonEnabled; }
 
+        // What is stored in the character database, to only write it when it changes
+        void SetSavedState(uint32 inCapabilities, uint32 inQuestLogHash) { savedCapabilities = inCapabilities; savedQuestLogHash = inQuestLogHash; }
+        uint32 GetSavedCapabilities() const { return savedCapabilities; }
+        uint32 GetSavedQuestLogHash() const { return savedQuestLogHash; }
+
+        // Token bucket and dedupe of the addon requests. Only called from the chat command
+        // handlers, which run on the player's session one at a time. An accepted IN_FLIGHT
+        // request has to be finished once its reply is queued.
+        RequestResult CheckRequest(uint64 requestKey, RequestDedupe dedupe);
+        void FinishRequest(uint64 requestKey);
+
+        // Sound events pushed with the quest and gossip frames. Marking returns false if the
+        // same event was already pushed since the last player update, as the core sends some
+        // frames more than once while handling a packet. Reopening the frame pushes it again.
+        bool MarkEventPushed(uint64 eventKey);
+        void ClearPushedEvents();
+
+        // The quest log as the addon was last told about it. Every change to it gets the next
+        // sequence number and the latest ones are kept, so an addon that missed some can ask
+        // for them instead of the whole quest log. Resetting returns the sequence number it starts from.
+        uint32 ResetQuestLog(const std::vector<uint32>& questIds);
+        // False if the addon already knows the quest is (or isn't) in the quest log
+        bool AddQuestLogDelta(uint32 questId, const ObjectGuid* questGiver, bool added, QuestLogDelta& delta);
+        // The changes after the given sequence number, false if they aren't all kept anymore
+        bool GetQuestLogDeltas(uint32 sinceSequence, std::vector<QuestLogDelta>& deltas) const;
+
+        // Addon messages waiting for the next player update, filled from any thread
+        VoiceoverOutboundQueue& GetOutboundQueue() const { return outboundQueue; }
+
+        // Map instance the player listens for creature texts on, only changed from the player's own updates
+        void SetListenerMapKey(uint64 mapKey) { listenerMapKey = mapKey; }
+        uint64 GetListenerMapKey() const { return listenerMapKey; }
+
+        // Where the player was on its last update and the zones the addon got the quest hints of.
+        // Only used from the player's own updates and requests, the addon forgets them on a new handshake.
+        bool SetHintLocation(uint32 zoneId, uint32 areaId);
+        bool MarkZoneHinted(uint32 zoneId);
+        void ResetZoneQuestHints();
+
+    private:
+        static constexpr uint8 MAX_RECENT_REQUESTS = 8;
+        static constexpr uint8 MAX_QUEST_LOG_DELTAS = 32;
+
+        struct RecentRequest
+        {
+            uint64 key = 0;
+            uint32 time = 0;
+        };
+
     private:
         Player* player;
         VoiceoverModule* module;
-        bool addonEnabled;
+        std::atomic<uint32> capabilities;
+        std::atomic<bool> addonEnabled;
+
+        uint32 savedCapabilities;
+        uint32 savedQuestLogHash;
+
+        // Available requests in thousandths, refilled on every request by the time elapsed since the last one
+        uint32 requestTokens;
+        uint32 lastRequestTime;
+
+        RecentRequest recentRequests[MAX_RECENT_REQUESTS];
+        uint8 nextRecentRequest;
+
+        // Sound event requests waiting on a resolver worker, finished from the world update
+        std::mutex inFlightMutex;
+        uint64 inFlightRequests[MAX_RECENT_REQUESTS] = {};
+
+        uint64 pushedEvents[MAX_RECENT_REQUESTS] = {};
+        uint8 nextPushedEvent;
+
+        // Changed by the quest hooks and read by the chat command handlers
+        mutable std::mutex questLogMutex;
+        std::vector<uint32> questLogIds;
+        QuestLogDelta questLogDeltas[MAX_QUEST_LOG_DELTAS];
+        uint32 questLogSequence;
+        uint32 questLogDeltaCount;
+
+        mutable VoiceoverOutboundQueue outboundQueue;
+        std::atomic<uint64> listenerMapKey;
+
+        uint32 hintZoneId;
+        uint32 hintAreaId;
+        std::vector<uint32> hintedZones;
     };
 
     class VoiceoverModule : public Module
     {
     public:
         VoiceoverModule();
+        ~VoiceoverModule();
         const VoiceoverModuleConfig* GetConfig() const override;
 
+        // Module Hooks
+        void OnInitialize() override;
+        void OnUpdate(uint32 elapsed) override;
+
         // Player Hooks
-        void OnCharacterCreated(Player* player) override;
         void OnPreLoadFromDB(Player* player) override;
+        void OnSaveToDB(Player* player) override;
         void OnLogOut(Player* player) override;
+        void OnUpdate(Player* player, uint32 diff) override;
+        void OnCharacterDeleted(uint32 playerId) override;
 
         // Player Action Hooks
         void OnAcceptQuest(Player* player, uint32 questId, const ObjectGuid* questGiver);
         void OnAbandonQuest(Player* player, uint32 questId);
 
+        // Quest Log Hooks, called whenever a quest enters or leaves the quest log however it happened
+        // (GM commands, shared or scripted quests, turning it in). A quest already announced by
+        // OnAcceptQuest or OnAbandonQuest isn't sent again. Failed quests stay in the quest log
+        // until they are abandoned, so failing one changes nothing for the addon. Not part of the
+        // module hooks of the core, without them only accepting and abandoning a quest send deltas.
+        void OnAddQuest(Player* player, uint32 questId);
+        void OnRemoveQuest(Player* player, uint32 questId);
+        void OnRewardQuest(Player* player, uint32 questId);
+
+        // Dialog Hooks, called right after the core sends the quest and gossip frames. The sound
+        // event is pushed along with the frame so the addon doesn't have to request it. Not part of
+        // the module hooks of the core, see the README for where a core has to call them.
+        void OnSendQuestDetails(Player* player, uint32 questId, const ObjectGuid& questGiver);
+        void OnSendQuestRequestItems(Player* player, uint32 questId, const ObjectGuid& questGiver);
+        void OnSendQuestOfferReward(Player* player, uint32 questId, const ObjectGuid& questGiver);
+        void OnSendQuestGreeting(Player* player, const ObjectGuid& questGiver, const std::string& text);
+        void OnSendGossipMenu(Player* player, const ObjectGuid& gossipGiver, const std::string& text);
+
+        // Chat Hooks, called by the core for every chat message a player sends before it is handled.
+        // Addons granted the addon channel whisper their requests to their own player as
+        // "voiceover\t<command> <args>", those are handled here without going through the chat
+        // command lookup. Returns true for them so the core drops the message instead of delivering it.
+        // Not part of the module hooks of the core, see the README.
+        bool OnHandleChatMessage(Player* player, uint32 type, const std::string& message);
+
+        // Called by the core for every say and yell of a creature, with the text in the default locale.
+        // The lines are kept until the next world update, which looks each one up once and sends the
+        // same message to all the players in hearing range that asked for creature texts. Not part of the
+        // module hooks of the core, see the README.
+        void OnCreatureChat(const Creature* creature, uint32 chatType, const std::string& text);
+
         std::vector<ModuleChatCommand>* GetCommandTable() override;
         const char* GetChatCommandPrefix() const override { return "voiceover"; }
         bool HandleEnableAddon(WorldSession* session, const std::string& args);
         bool HandleQuestLogRequest(WorldSession* session, const std::string& args);
         bool HandleSoundEventRequest(WorldSession* session, const std::string& args);
+        bool HandleReloadRequest(WorldSession* session, const std::string& args);
+        bool HandleStatsRequest(WorldSession* session, const std::string& args);
+        bool HandleTraceRequest(WorldSession* session, const std::string& args);
+
+        // Number of times the reusable addon message packets had to grow, stays flat once warmed up
+        uint64 GetAddonMessageAllocations() const;
+
+        // Addon requests ignored for repeating a recent one or for going over the rate limit
+        uint64 GetCoalescedRequests() const { return metrics.GetSnapshot().Get(MetricCounter::COALESCED_REQUESTS); }
+        uint64 GetRateLimitedRequests() const { return metrics.GetSnapshot().Get(MetricCounter::RATE_LIMITED_REQUESTS); }
+
+        VoiceoverMetrics::Snapshot GetMetrics() const { return metrics.GetSnapshot(); }
+        uint32 GetActiveAddonUsers() const;
+
+        // Sound events waiting for a worker and replies waiting for the next world update
+        size_t GetQueuedSoundEvents() const { return resolverPool.GetQueuedJobs(); }
+        size_t GetQueuedReplies() const { return completedSoundEvents.GetSize(); }
 
     private:
         VoiceoverPlayerMgr* GetVoiceoverPlayerMgr(Player* player);
         const VoiceoverPlayerMgr* GetVoiceoverPlayerMgr(const Player* player) const;
 
         bool IsAddonEnabled(const Player* player) const;
+        bool HasAddonCapability(const Player* player, AddonCapability capability) const;
+        AddonProtocol GetAddonProtocol(const Player* player) const;
+        uint32 GetSupportedCapabilities() const;
+
+        // Some capabilities need hooks that not every core calls, they are only granted to the
+        // addons that handshake after the core called one of them
+        void MarkHookCalled(AddonCapability capability);
+        bool AcceptRequest(VoiceoverPlayerMgr* playerMgr, uint64 requestKey, RequestDedupe dedupe);
+        std::vector<std::string> FormatStats() const;
+        static bool IsValidTraceFileName(const std::string& fileName);
+
+        // The chat commands and the addon channel both end up here, after the checks shared by every request
+        bool HandleAddonCommand(Player* player, AddonCommand command, std::string_view args);
+        bool ProcessEnableAddon(Player* player, std::string_view args);
+        bool ProcessQuestLogRequest(Player* player, std::string_view args);
+        bool ProcessSoundEventRequest(Player* player, std::string_view args);
 
+        // What was saved of the last session, read by the first handshake of the character's session
+        void LoadPlayerState(const Player* player, VoiceoverPlayerMgr* playerMgr);
+        void SavePlayerState(const Player* player);
+        uint32 GetQuestLogHash(const Player* player) const;
+
+        // Quests of the quest log with a voiceover, the ones the addon keeps track of
+        std::vector<uint32> GetVoicedQuestLog(const Player* player) const;
+
+        // Tells the addon about the quest entering or leaving the quest log if it didn't know yet
+        void UpdateQuestLog(Player* player, uint32 questId, const ObjectGuid* questGiver, bool added);
+        void SendQuestLogDelta(const Player* player, const QuestLogDelta& delta);
+
+        QuestPayload GetQuestPayload(const Player* player, const Quest* quest, const ObjectGuid* questGiverGuid = nullptr);
+        QuestPayload GetQuestPayload(const Quest* quest, QuestStarterType questGiverType, uint32 questGiverEntry, int localeIndex, AddonProtocol protocol);
+
+        // Quest events without a known giver are attributed to whoever starts the quest
+        void ResolveQuestGiver(const Quest* quest, QuestStarterType& questGiverType, uint32& questGiverEntry) const;
+
+        // The indexes are replaced as a whole on reload, readers keep the one they got until they are done
+        void LoadIndexes();
+        std::shared_ptr<const VoiceoverQuestIndex> GetQuestIndex() const { return std::atomic_load(&questIndex); }
+        std::shared_ptr<const VoiceoverGossipIndex> GetGossipIndex() const { return std::atomic_load(&gossipIndex); }
+        std::shared_ptr<const VoiceoverVoiceManifest> GetVoiceManifest() const { return std::atomic_load(&voiceManifest); }
+        std::shared_ptr<const VoiceoverZoneIndex> GetZoneIndex() const { return std::atomic_load(&zoneIndex); }
+
+        // Looks the sound event up in the indexes. Only reads the index snapshots, so it can run on any thread.
+        void ResolveSoundEvent(SoundEventResult& result);
+
+        // Builds the SoundEvent reply of a resolved request, on the world thread
+        std::string FormatSoundEvent(const SoundEventResult& result);
+
+        // Resolves the request on the worker pool when there is one and sends the reply
+        void SubmitSoundEvent(Player* player, SoundEventRequest&& request);
+        void SendSoundEvent(Player* player, const SoundEventResult& result);
+        void PushSoundEvent(Player* player, SoundEvent eventType, uint32 questId, const ObjectGuid& giver, const std::string& text);
+
+        // Addon messages are queued and sent on the player's next update, see FlushAddonMessages
         void SendAddonMessage(const Player* player, const char* message) const;
+        void SendAddonMessage(const Player* player, const char* message, size_t length, AddonMessagePriority priority = AddonMessagePriority::QUEST_LOG) const;
         void PSendAddonMessage(const Player* player, const char* format, ...) const;
+        void SendAddonMessage(const Player* player, const char* header, uint8 status, const std::string& payload) const;
+        void FlushAddonMessages(const Player* player, VoiceoverOutboundQueue& queue) const;
+        void SendAddonPacket(const Player* player, const char* message, size_t length) const;
+        // The sequence number is only sent to addons using the quest log deltas, 0 leaves it out
+        void SendQuestLogSnapshot(const Player* player, const std::vector<QuestPayload>& payloads, AddonProtocol protocol, uint32 questLogSequence) const;
+
+        // Sends the creature texts said since the last world update to their listeners
+        void SendCreatureTexts();
+        // Sends the quest hints of the zone and area the player entered, if the addon doesn't have them yet
+        void SendZoneQuestHints(const Player* player, VoiceoverPlayerMgr* playerMgr);
+
+    private:
+        struct AddonCommandHandler
+        {
+            MetricTimer timer;
+            MetricCounter calls;
+            bool (VoiceoverModule::*function)(Player* player, std::string_view args);
+        };
+
+        // Indexed by command, defined at compile time in the module source
+        static const AddonCommandHandler addonCommandHandlers[(uint8)AddonCommand::MAX];
 
     private:
-        std::unordered_map<uint32, VoiceoverPlayerMgr> playerMgrs;
+        VoiceoverPlayerStore<VoiceoverPlayerMgr> playerMgrs;
+        std::atomic<uint32> calledHookCapabilities;
+        std::shared_ptr<const VoiceoverQuestIndex> questIndex;
+        std::shared_ptr<const VoiceoverGossipIndex> gossipIndex;
+        std::shared_ptr<const VoiceoverVoiceManifest> voiceManifest;
+        std::shared_ptr<const VoiceoverZoneIndex> zoneIndex;
+        VoiceoverPayloadCache payloadCache;
+
+        VoiceoverWorkerPool resolverPool;
+        VoiceoverCompletionQueue<SoundEventResult> completedSoundEvents;
+
+        VoiceoverCreatureTexts creatureTexts;
+        // Only used from the world update, they keep their storage between updates
+        std::vector<CreatureText> creatureTextBatch;
+        std::vector<CreatureTextMessage> creatureTextMessages;
+
+        VoiceoverMetrics metrics;
+        uint32 statsLogTimer = 0;
+
+        VoiceoverTraceRecorder traceRecorder;
     };
 }
 #endif
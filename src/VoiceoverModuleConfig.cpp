@@ -5,6 +5,17 @@ namespace cmangos_module
     VoiceoverModuleConfig::VoiceoverModuleConfig()
     : ModuleConfig("voiceover.conf")
     , enabled(false)
+    , indexSnapshotRebuild(IndexSnapshotRebuild::ON_CHANGE)
+    , rateLimitBurst(0)
+    , rateLimitPerSecond(0)
+    , dedupeWindow(0)
+    , pushSoundEvents(false)
+    , addonChannel(false)
+    , creatureTexts(false)
+    , zoneQuestHints(false)
+    , laggingClientLatency(0)
+    , resolverThreads(0)
+    , statsLogInterval(0)
     {
 
     }
@@ -12,6 +23,21 @@ namespace cmangos_module
     bool VoiceoverModuleConfig::OnLoad()
     {
         enabled = config.GetBoolDefault("Voiceover.Enable", false);
+        gossipLookupFile = config.GetStringDefault("Voiceover.GossipLookupFile", "");
+        voiceManifestFile = config.GetStringDefault("Voiceover.VoiceManifestFile", "");
+        indexSnapshotFile = config.GetStringDefault("Voiceover.IndexSnapshotFile", "");
+        indexSnapshotRebuild = (IndexSnapshotRebuild)config.GetIntDefault("Voiceover.IndexSnapshotRebuild", (int32)IndexSnapshotRebuild::ON_CHANGE);
+        rateLimitBurst = config.GetIntDefault("Voiceover.RateLimit.Burst", 10);
+        rateLimitPerSecond = config.GetIntDefault("Voiceover.RateLimit.PerSecond", 4);
+        dedupeWindow = config.GetIntDefault("Voiceover.DedupeWindow", 1000);
+        pushSoundEvents = config.GetBoolDefault("Voiceover.PushSoundEvents", false);
+        addonChannel = config.GetBoolDefault("Voiceover.AddonChannel", false);
+        creatureTexts = config.GetBoolDefault("Voiceover.CreatureTexts", false);
+        zoneQuestHints = config.GetBoolDefault("Voiceover.ZoneQuestHints", true);
+        laggingClientLatency = config.GetIntDefault("Voiceover.LaggingClientLatency", 400);
+        resolverThreads = config.GetIntDefault("Voiceover.ResolverThreads", 2);
+        statsLogInterval = config.GetIntDefault("Voiceover.StatsLogInterval", 0);
+        traceDirectory = config.GetStringDefault("Voiceover.TraceDirectory", "");
         return true;
     }
 }
\ No newline at end of file
@@ -1,8 +1,17 @@
 #pragma once
 #include "ModuleConfig.h"
 
+#include <string>
+
 namespace cmangos_module
 {
+    enum class IndexSnapshotRebuild : uint8
+    {
+        ON_CHANGE = 0,
+        ALWAYS = 1,
+        NEVER = 2
+    };
+
     class VoiceoverModuleConfig : public ModuleConfig
     {
     public:
@@ -11,5 +20,20 @@ namespace cmangos_module
 
     public:
         bool enabled;
+        std::string gossipLookupFile;
+        std::string voiceManifestFile;
+        std::string indexSnapshotFile;
+        IndexSnapshotRebuild indexSnapshotRebuild;
+        uint32 rateLimitBurst;
+        uint32 rateLimitPerSecond;
+        uint32 dedupeWindow;
+        bool pushSoundEvents;
+        bool addonChannel;
+        bool creatureTexts;
+        bool zoneQuestHints;
+        uint32 laggingClientLatency;
+        uint32 resolverThreads;
+        uint32 statsLogInterval;
+        std::string traceDirectory;
     };
 }
\ No newline at end of file
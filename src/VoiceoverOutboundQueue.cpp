@@ -0,0 +1,24 @@
+#include "VoiceoverOutboundQueue.h"
+
+namespace cmangos_module
+{
+    void VoiceoverOutboundQueue::Push(AddonMessagePriority priority, const char* message, size_t length)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string& queued = messages[(uint8)priority];
+        queued.append(message, length);
+        queued += '\n';
+        queuedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void VoiceoverOutboundQueue::Clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::string& queued : messages)
+        {
+            queued.clear();
+        }
+
+        queuedMessages.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_OUTBOUND_QUEUE_H
+#define CMANGOS_MODULE_VOICEOVER_OUTBOUND_QUEUE_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace cmangos_module
+{
+    // Separates the messages batched into a single addon message
+    constexpr char ADDON_MESSAGE_SEPARATOR = '\x1E';
+
+    enum class AddonMessagePriority : uint8
+    {
+        // Replies the player is waiting on to start a voiceover
+        SOUND_EVENT,
+        // The handshake and the quest log sync, which must keep their order among themselves
+        QUEST_LOG,
+        MAX
+    };
+
+    // Addon messages of one player waiting for the player's next update, when they are sent
+    // together. Sound events go out first and the quest log messages of a lagging client are
+    // sent a little at a time instead of all at once. Messages can be pushed from any thread.
+    class VoiceoverOutboundQueue
+    {
+    public:
+        struct FlushOptions
+        {
+            // Longest addon message text, without the prefix
+            size_t maxLength = 0;
+            // Join several messages into one addon message, only for addons that split them again
+            bool batch = false;
+            // Quest log bytes sent in this flush, the first message always goes
+            size_t questLogBudget = SIZE_MAX;
+        };
+
+        struct FlushResult
+        {
+            uint32 lines = 0;
+            uint32 messages = 0;
+            bool heldBack = false;
+        };
+
+    public:
+        VoiceoverOutboundQueue() : queuedMessages(0) {}
+
+        // A message is a single line, the caller splits longer texts
+        void Push(AddonMessagePriority priority, const char* message, size_t length);
+
+        bool IsEmpty() const { return queuedMessages.load(std::memory_order_relaxed) == 0; }
+        void Clear();
+
+        // Calls send(text, length) for every addon message to send
+        template<class Send>
+        FlushResult Flush(const FlushOptions& options, Send&& send);
+
+    private:
+        mutable std::mutex mutex;
+        std::atomic<uint32> queuedMessages;
+
+        // Messages of each priority, each one ends with a '\n'. The buffers keep their storage once flushed.
+        std::string messages[(uint8)AddonMessagePriority::MAX];
+        std::string line;
+    };
+
+    template<class Send>
+    VoiceoverOutboundQueue::FlushResult VoiceoverOutboundQueue::Flush(const FlushOptions& options, Send&& send)
+    {
+        FlushResult result;
+        std::lock_guard<std::mutex> lock(mutex);
+        line.clear();
+
+        for (uint8 priority = 0; priority < (uint8)AddonMessagePriority::MAX; ++priority)
+        {
+            std::string& queued = messages[priority];
+            size_t budget = priority == (uint8)AddonMessagePriority::QUEST_LOG ? options.questLogBudget : SIZE_MAX;
+            size_t pos = 0;
+            while (pos < queued.size())
+            {
+                const size_t end = queued.find('\n', pos);
+                const size_t length = end - pos;
+                if (pos > 0 && length > budget)
+                {
+                    result.heldBack = true;
+                    break;
+                }
+
+                // Messages are added to the current addon message while they fit
+                if (!options.batch || line.empty() || line.size() + 1 + length > options.maxLength)
+                {
+                    if (!line.empty())
+                    {
+                        send(line.data(), line.size());
+                        result.lines++;
+                        line.clear();
+                    }
+                }
+                else
+                {
+                    line += ADDON_MESSAGE_SEPARATOR;
+                }
+
+                line.append(queued, pos, length);
+                budget -= std::min(budget, length);
+                result.messages++;
+                pos = end + 1;
+            }
+
+            queued.erase(0, pos);
+        }
+
+        if (!line.empty())
+        {
+            send(line.data(), line.size());
+            result.lines++;
+        }
+
+        queuedMessages.fetch_sub(result.messages, std::memory_order_relaxed);
+        return result;
+    }
+}
+#endif
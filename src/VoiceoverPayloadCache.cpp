@@ -0,0 +1,250 @@
+#include "VoiceoverPayloadCache.h"
+
+#include "Globals/ObjectMgr.h"
+
+#include <mutex>
+
+namespace cmangos_module
+{
+    // Largest giver entry that fits in the 24 bits of the payload keys
+    constexpr uint32 MAX_PAYLOAD_GIVER_ENTRY = 0xFFFFFF;
+
+    const char* GetObjectTypeStrFromStarterType(QuestStarterType type)
+    {
+        switch (type)
+        {
+            case QuestStarterType::CREATURE: return "Creature";
+            case QuestStarterType::GAMEOBJECT: return "GameObject";
+            case QuestStarterType::ITEM: return "Item";
+            default: return "";
+        }
+    }
+
+    char GetObjectTypeCharFromStarterType(QuestStarterType type)
+    {
+        switch (type)
+        {
+            case QuestStarterType::CREATURE: return 'c';
+            case QuestStarterType::GAMEOBJECT: return 'o';
+            case QuestStarterType::ITEM: return 'i';
+            default: return '\0';
+        }
+    }
+
+    void AppendBase36(std::string& str, uint32 value)
+    {
+        char digits[8];
+        size_t count = 0;
+        do
+        {
+            digits[count++] = "0123456789abcdefghijklmnopqrstuvwxyz"[value % 36];
+            value /= 36;
+        }
+        while (value > 0);
+
+        while (count > 0)
+        {
+            str.push_back(digits[--count]);
+        }
+    }
+
+    void AppendQuestGiver(std::string& str, AddonProtocol protocol, QuestStarterType giverType, uint32 giverEntry)
+    {
+        if (protocol == AddonProtocol::V2)
+        {
+            if (const char typeChar = GetObjectTypeCharFromStarterType(giverType))
+            {
+                str.push_back(typeChar);
+                AppendBase36(str, giverEntry);
+            }
+        }
+        else
+        {
+            str.append(GetObjectTypeStrFromStarterType(giverType)).append("-0-0-0-0-").append(std::to_string(giverEntry)).append("-0");
+        }
+    }
+
+    QuestPayload VoiceoverPayloadCache::GetQuestPayload(const Quest* quest, QuestStarterType giverType, uint32 giverEntry, int localeIndex, AddonProtocol protocol)
+    {
+        if (!quest)
+        {
+            return nullptr;
+        }
+
+        // The key has no room for larger entries, their payloads are built every time
+        if (giverEntry > MAX_PAYLOAD_GIVER_ENTRY)
+        {
+            return std::make_shared<const std::string>(BuildQuestPayload(quest, giverType, giverEntry, localeIndex, protocol));
+        }
+
+        const uint64 key = MakePayloadKey(quest->GetQuestId(), giverType, giverEntry, localeIndex, protocol);
+
+        uint32 builtGeneration;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto payloadIt = payloads.find(key);
+            if (payloadIt != payloads.end())
+            {
+                return payloadIt->second;
+            }
+
+            builtGeneration = generation;
+        }
+
+        QuestPayload payload = std::make_shared<const std::string>(BuildQuestPayload(quest, giverType, giverEntry, localeIndex, protocol));
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+
+        // The cache was cleared while the payload was built, it may be from the tables before a reload
+        if (builtGeneration != generation)
+        {
+            return payload;
+        }
+
+        auto result = payloads.emplace(key, payload);
+        if (result.second)
+        {
+            payloadBytes += payload->capacity();
+        }
+
+        // Another thread may have filled the entry while the lock was released
+        return result.first->second;
+    }
+
+    void VoiceoverPayloadCache::Clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        payloads.clear();
+        payloadBytes = 0;
+        ++generation;
+    }
+
+    size_t VoiceoverPayloadCache::GetPayloadCount() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return payloads.size();
+    }
+
+    size_t VoiceoverPayloadCache::GetMemoryUsage() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        // Hash node (key, pointer and chaining) plus the shared string and its control block
+        const size_t entrySize = sizeof(uint64) + sizeof(QuestPayload) + sizeof(void*) * 2 + sizeof(std::string) + sizeof(void*) * 2;
+        return payloads.size() * entrySize + payloads.bucket_count() * sizeof(void*) + payloadBytes;
+    }
+
+    std::string VoiceoverPayloadCache::GetQuestGiverName(QuestStarterType giverType, uint32 giverEntry, int localeIndex)
+    {
+        std::string questGiverName;
+        switch (giverType)
+        {
+            case QuestStarterType::CREATURE:
+            {
+                if (localeIndex >= 0)
+                {
+                    const char* creatureName = nullptr;
+                    sObjectMgr.GetCreatureLocaleStrings(giverEntry, localeIndex, &creatureName);
+                    questGiverName = creatureName ? creatureName : "";
+                }
+
+                if (questGiverName.empty())
+                {
+                    if (const CreatureInfo* creatureInfo = sObjectMgr.GetCreatureTemplate(giverEntry))
+                    {
+                        questGiverName = creatureInfo->Name;
+                    }
+                }
+
+                break;
+            }
+
+            case QuestStarterType::GAMEOBJECT:
+            {
+                if (localeIndex >= 0)
+                {
+                    if (const GameObjectLocale* gameObjectLocale = sObjectMgr.GetGameObjectLocale(giverEntry))
+                    {
+                        if (gameObjectLocale->Name.size() > (size_t)localeIndex)
+                        {
+                            questGiverName = gameObjectLocale->Name[localeIndex];
+                        }
+                    }
+                }
+
+                if (questGiverName.empty())
+                {
+                    if (const GameObjectInfo* gameObjectInfo = sObjectMgr.GetGameObjectInfo(giverEntry))
+                    {
+                        questGiverName = gameObjectInfo->name;
+                    }
+                }
+
+                break;
+            }
+
+            case QuestStarterType::ITEM:
+            {
+                if (localeIndex >= 0)
+                {
+                    if (const ItemLocale* itemLocale = sObjectMgr.GetItemLocale(giverEntry))
+                    {
+                        if (itemLocale->Name.size() > (size_t)localeIndex)
+                        {
+                            questGiverName = itemLocale->Name[localeIndex];
+                        }
+                    }
+                }
+
+                if (questGiverName.empty())
+                {
+                    if (const ItemPrototype* itemProto = sObjectMgr.GetItemPrototype(giverEntry))
+                    {
+                        questGiverName = itemProto->Name1;
+                    }
+                }
+
+                break;
+            }
+
+            default: break;
+        }
+
+        return questGiverName;
+    }
+
+    std::string VoiceoverPayloadCache::BuildQuestPayload(const Quest* quest, QuestStarterType giverType, uint32 giverEntry, int localeIndex, AddonProtocol protocol)
+    {
+        const std::string& questTitle = VoiceoverQuestIndex::GetQuestTitle(quest, localeIndex);
+        const std::string questGiverName = GetQuestGiverName(giverType, giverEntry, localeIndex);
+
+        std::string payload;
+        payload.reserve(questTitle.size() + questGiverName.size() + 48);
+        if (protocol == AddonProtocol::V2)
+        {
+            AppendBase36(payload, quest->GetQuestId());
+        }
+        else
+        {
+            payload.append(std::to_string(quest->GetQuestId()));
+        }
+
+        payload.append(";");
+        AppendQuestGiver(payload, protocol, giverType, giverEntry);
+        payload.append(";");
+        payload.append(questTitle).append(";");
+        payload.append(questGiverName);
+        payload.shrink_to_fit();
+        return payload;
+    }
+
+    uint64 VoiceoverPayloadCache::MakePayloadKey(uint32 questId, QuestStarterType giverType, uint32 giverEntry, int localeIndex, AddonProtocol protocol)
+    {
+        // [v2:1][locale:5][giver type:2][giver entry:24][quest id:32]
+        return ((uint64)(protocol == AddonProtocol::V2 ? 1 : 0) << 63) |
+               ((uint64)((localeIndex + 1) & 0x1F) << 58) |
+               ((uint64)((uint8)giverType & 0x3) << 56) |
+               ((uint64)giverEntry << 32) |
+               (uint64)questId;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_PAYLOAD_CACHE_H
+#define CMANGOS_MODULE_VOICEOVER_PAYLOAD_CACHE_H
+
+#include "VoiceoverQuestIndex.h"
+
+#include <memory>
+#include <shared_mutex>
+
+namespace cmangos_module
+{
+    typedef std::shared_ptr<const std::string> QuestPayload;
+
+    // Addon message format. V2 is negotiated in the enableAddon handshake, it writes the
+    // numbers in base 36 and the givers as a type character followed by their entry.
+    enum class AddonProtocol : uint8
+    {
+        V1 = 1,
+        V2 = 2
+    };
+
+    // Object type as written in the giver GUIDs of the addon messages
+    const char* GetObjectTypeStrFromStarterType(QuestStarterType type);
+
+    // Object type as written in front of the giver entries of the v2 addon messages
+    char GetObjectTypeCharFromStarterType(QuestStarterType type);
+
+    void AppendBase36(std::string& str, uint32 value);
+
+    // "Creature-0-0-0-0-entry-0" in v1, "c<entry>" in v2 and nothing for an unknown v2 giver
+    void AppendQuestGiver(std::string& str, AddonProtocol protocol, QuestStarterType giverType, uint32 giverEntry);
+
+    // Lazily filled cache of the "questId;giverGUID;questTitle;giverName" part of the
+    // QuestLog and SoundEvent addon messages. The text only depends on the quest,
+    // the giver, the client locale and the protocol so it is formatted once and shared afterwards.
+    // Clearing starts a new generation, payloads built from the tables of an older one aren't kept.
+    class VoiceoverPayloadCache
+    {
+    public:
+        QuestPayload GetQuestPayload(const Quest* quest, QuestStarterType giverType, uint32 giverEntry, int localeIndex, AddonProtocol protocol);
+        void Clear();
+
+        size_t GetPayloadCount() const;
+        size_t GetMemoryUsage() const;
+
+        static std::string GetQuestGiverName(QuestStarterType giverType, uint32 giverEntry, int localeIndex);
+
+    private:
+        static std::string BuildQuestPayload(const Quest* quest, QuestStarterType giverType, uint32 giverEntry, int localeIndex, AddonProtocol protocol);
+        static uint64 MakePayloadKey(uint32 questId, QuestStarterType giverType, uint32 giverEntry, int localeIndex, AddonProtocol protocol);
+
+    private:
+        mutable std::shared_mutex mutex;
+        std::unordered_map<uint64, QuestPayload> payloads;
+        size_t payloadBytes = 0;
+        uint32 generation = 0;
+    };
+}
+#endif
@@ -0,0 +1,182 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_PLAYER_STORE_H
+#define CMANGOS_MODULE_VOICEOVER_PLAYER_STORE_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cmangos_module
+{
+    // Per player state keyed by guid counter. The counter is split in four bytes that
+    // index a radix tree of 256 slot pages, so a lookup is four atomic loads and never
+    // takes a lock. Pages are only allocated for the counter ranges that are in use and
+    // entries only exist for players that asked for them.
+    //
+    // Erased entries are unlinked immediately but only destroyed two Reclaim() calls
+    // later. Reclaim() runs once per world update, so a reader on any thread can keep
+    // using an entry until the end of the update it was looked up in.
+    template<class T>
+    class VoiceoverPlayerStore
+    {
+        static constexpr uint32 PAGE_BITS = 8;
+        static constexpr uint32 PAGE_SIZE = 1 << PAGE_BITS;
+        static constexpr uint32 PAGE_MASK = PAGE_SIZE - 1;
+
+        template<class U>
+        struct Page
+        {
+            Page()
+            {
+                for (std::atomic<U*>& slot : slots)
+                {
+                    slot.store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            ~Page()
+            {
+                for (std::atomic<U*>& slot : slots)
+                {
+                    delete slot.load(std::memory_order_relaxed);
+                }
+            }
+
+            std::atomic<U*> slots[PAGE_SIZE];
+        };
+
+        typedef Page<T> LeafPage;
+        typedef Page<LeafPage> InnerPage;
+        typedef Page<InnerPage> OuterPage;
+        typedef Page<OuterPage> RootPage;
+
+    public:
+        VoiceoverPlayerStore() : root(new RootPage()), count(0) {}
+        VoiceoverPlayerStore(const VoiceoverPlayerStore&) = delete;
+        VoiceoverPlayerStore& operator=(const VoiceoverPlayerStore&) = delete;
+
+        T* Find(uint32 playerId) const
+        {
+            if (OuterPage* outer = root->slots[playerId >> (PAGE_BITS * 3)].load(std::memory_order_acquire))
+            {
+                if (InnerPage* inner = outer->slots[(playerId >> (PAGE_BITS * 2)) & PAGE_MASK].load(std::memory_order_acquire))
+                {
+                    if (LeafPage* leaf = inner->slots[(playerId >> PAGE_BITS) & PAGE_MASK].load(std::memory_order_acquire))
+                    {
+                        return leaf->slots[playerId & PAGE_MASK].load(std::memory_order_acquire);
+                    }
+                }
+            }
+
+            return nullptr;
+        }
+
+        // Returns the existing entry or stores a new one built from the given arguments
+        template<class... Args>
+        T* Insert(uint32 playerId, Args&&... args)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            std::atomic<T*>& slot = GetSlot(playerId);
+            T* entry = slot.load(std::memory_order_relaxed);
+            if (!entry)
+            {
+                entry = new T(std::forward<Args>(args)...);
+                slot.store(entry, std::memory_order_release);
+                ++count;
+            }
+
+            return entry;
+        }
+
+        void Erase(uint32 playerId)
+        {
+            if (Find(playerId))
+            {
+                std::lock_guard<std::mutex> lock(writeMutex);
+
+                std::atomic<T*>& slot = GetSlot(playerId);
+                if (T* entry = slot.exchange(nullptr, std::memory_order_acq_rel))
+                {
+                    retiring.emplace_back(entry);
+                    --count;
+                }
+            }
+        }
+
+        // Destroys the entries erased before the previous call
+        void Reclaim()
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            retired.clear();
+            retired.swap(retiring);
+        }
+
+        uint32 GetCount() const { return count; }
+
+        // Visits every live entry, must not be used concurrently with Erase
+        template<class F>
+        void ForEach(F&& visitor) const
+        {
+            for (std::atomic<OuterPage*>& outerSlot : root->slots)
+            {
+                if (OuterPage* outer = outerSlot.load(std::memory_order_acquire))
+                {
+                    for (std::atomic<InnerPage*>& innerSlot : outer->slots)
+                    {
+                        if (InnerPage* inner = innerSlot.load(std::memory_order_acquire))
+                        {
+                            for (std::atomic<LeafPage*>& leafSlot : inner->slots)
+                            {
+                                if (LeafPage* leaf = leafSlot.load(std::memory_order_acquire))
+                                {
+                                    for (std::atomic<T*>& slot : leaf->slots)
+                                    {
+                                        if (T* entry = slot.load(std::memory_order_acquire))
+                                        {
+                                            visitor(*entry);
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        template<class U>
+        static U* GetOrCreatePage(std::atomic<U*>& slot)
+        {
+            U* page = slot.load(std::memory_order_relaxed);
+            if (!page)
+            {
+                page = new U();
+                slot.store(page, std::memory_order_release);
+            }
+
+            return page;
+        }
+
+        // Must be called with the write mutex held
+        std::atomic<T*>& GetSlot(uint32 playerId)
+        {
+            OuterPage* outer = GetOrCreatePage(root->slots[playerId >> (PAGE_BITS * 3)]);
+            InnerPage* inner = GetOrCreatePage(outer->slots[(playerId >> (PAGE_BITS * 2)) & PAGE_MASK]);
+            LeafPage* leaf = GetOrCreatePage(inner->slots[(playerId >> PAGE_BITS) & PAGE_MASK]);
+            return leaf->slots[playerId & PAGE_MASK];
+        }
+
+    private:
+        std::unique_ptr<RootPage> root;
+        std::atomic<uint32> count;
+        std::mutex writeMutex;
+        std::vector<std::unique_ptr<T>> retiring;
+        std::vector<std::unique_ptr<T>> retired;
+    };
+}
+#endif
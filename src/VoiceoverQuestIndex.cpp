@@ -0,0 +1,498 @@
+#include "VoiceoverQuestIndex.h"
+#include "VoiceoverCaseFold.h"
+#include "VoiceoverIndexSnapshot.h"
+
+#include "Globals/ObjectMgr.h"
+#include "Server/SQLStorages.h"
+#include "Log/Log.h"
+
+#include <algorithm>
+#include <future>
+
+namespace cmangos_module
+{
+    // Slot 0 holds the default titles, slot N the titles of locale index N - 1
+    constexpr uint8 MAX_TITLE_LOCALE_SLOTS = 32;
+
+    // Sections of the quest index in the snapshot file
+    constexpr uint32 SNAPSHOT_QUEST_STARTERS = 1;
+    constexpr uint32 SNAPSHOT_QUEST_TITLES = 2;
+    constexpr uint32 SNAPSHOT_QUEST_TEXTS = 3;
+
+    constexpr uint64 CONTENT_HASH_SEED = 14695981039346656037ull;
+
+    // Starting value of the title check hash, any other than the one of the title hash
+    constexpr uint32 TITLE_CHECK_SEED = 0x9E3779B9;
+
+    uint64 HashContent(uint64 hash, const void* data, size_t size)
+    {
+        // 64 bit FNV-1a
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ static_cast<const uint8*>(data)[i]) * 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    uint64 HashContent(uint64 hash, uint32 value)
+    {
+        return HashContent(hash, &value, sizeof(value));
+    }
+
+    uint64 HashContent(uint64 hash, const std::string& text)
+    {
+        return HashContent(HashContent(hash, (uint32)text.size()), text.data(), text.size());
+    }
+
+    const std::string& GetQuestText(const Quest* quest, QuestTextType textType)
+    {
+        switch (textType)
+        {
+            case QuestTextType::REQUEST_ITEMS: return quest->GetRequestItemsText();
+            case QuestTextType::OFFER_REWARD: return quest->GetOfferRewardText();
+            default: return quest->GetDetails();
+        }
+    }
+
+    const std::vector<std::string>& GetQuestLocaleTexts(const QuestLocale* questLocale, QuestTextType textType)
+    {
+        switch (textType)
+        {
+            case QuestTextType::REQUEST_ITEMS: return questLocale->RequestItemsText;
+            case QuestTextType::OFFER_REWARD: return questLocale->OfferRewardText;
+            default: return questLocale->Details;
+        }
+    }
+
+    VoiceoverQuestIndex::VoiceoverQuestIndex()
+    {
+
+    }
+
+    VoiceoverQuestIndex::~VoiceoverQuestIndex()
+    {
+
+    }
+
+    void VoiceoverQuestIndex::Build()
+    {
+        Clear();
+
+        // Every relation table is indexed on its own thread, they only read the ObjectMgr tables
+        std::vector<QuestTitleRecord> titles[4];
+        std::future<void> titleTasks[] =
+        {
+            std::async(std::launch::async, [&titles]() { AddQuestTitles(titles[0], QuestRelationType::STARTER, QuestStarterType::CREATURE, sObjectMgr.GetCreatureQuestRelationsMap()); }),
+            std::async(std::launch::async, [&titles]() { AddQuestTitles(titles[1], QuestRelationType::ENDER, QuestStarterType::CREATURE, sObjectMgr.GetCreatureQuestInvolvedRelationsMap()); }),
+            std::async(std::launch::async, [&titles]() { AddQuestTitles(titles[2], QuestRelationType::STARTER, QuestStarterType::GAMEOBJECT, sObjectMgr.GetGOQuestRelationsMap()); }),
+            std::async(std::launch::async, [&titles]() { AddQuestTitles(titles[3], QuestRelationType::ENDER, QuestStarterType::GAMEOBJECT, sObjectMgr.GetGOQuestInvolvedRelationsMap()); })
+        };
+
+        // The first starter found wins, creatures take priority over gameobjects and items
+        const auto addQuestStarter = [this](uint32 questId, QuestStarterType type, uint32 entry)
+        {
+            QuestStarterRecord record;
+            record.questId = questId;
+            record.starter.type = type;
+            record.starter.entry = entry;
+            builtQuestStarters.push_back(record);
+        };
+
+        for (const auto& [entry, questId] : sObjectMgr.GetCreatureQuestRelationsMap())
+        {
+            addQuestStarter(questId, QuestStarterType::CREATURE, entry);
+        }
+
+        for (const auto& [entry, questId] : sObjectMgr.GetGOQuestRelationsMap())
+        {
+            addQuestStarter(questId, QuestStarterType::GAMEOBJECT, entry);
+        }
+
+        for (SQLStorageBase::SQLSIterator<ItemPrototype> itr = sItemStorage.getDataBegin<ItemPrototype>(); itr < sItemStorage.getDataEnd<ItemPrototype>(); ++itr)
+        {
+            if (itr->StartQuest)
+            {
+                addQuestStarter(itr->StartQuest, QuestStarterType::ITEM, itr->ItemId);
+            }
+        }
+
+        std::stable_sort(builtQuestStarters.begin(), builtQuestStarters.end());
+        builtQuestStarters.erase(std::unique(builtQuestStarters.begin(), builtQuestStarters.end(), [](const QuestStarterRecord& a, const QuestStarterRecord& b)
+        {
+            return a.questId == b.questId;
+        }), builtQuestStarters.end());
+        builtQuestStarters.shrink_to_fit();
+
+        size_t titleCount = 0;
+        for (uint8 i = 0; i < 4; ++i)
+        {
+            titleTasks[i].get();
+            titleCount += titles[i].size();
+        }
+
+        builtQuestTitles.reserve(titleCount);
+        for (const std::vector<QuestTitleRecord>& relationTitles : titles)
+        {
+            builtQuestTitles.insert(builtQuestTitles.end(), relationTitles.begin(), relationTitles.end());
+        }
+
+        std::sort(builtQuestTitles.begin(), builtQuestTitles.end());
+        AddQuestTexts(builtQuestTitles);
+
+        questStarters = builtQuestStarters.data();
+        questStarterCount = builtQuestStarters.size();
+        questTitles = builtQuestTitles.data();
+        questTitleCount = builtQuestTitles.size();
+        questTexts = builtQuestTexts.data();
+        questTextCount = builtQuestTexts.size();
+
+        sLog.outString(">> Voiceover: indexed %u quest starters, %u quest titles and %u texts of quests sharing a title", (uint32)questStarterCount, (uint32)questTitleCount, (uint32)questTextCount);
+    }
+
+    void VoiceoverQuestIndex::Clear()
+    {
+        questStarters = nullptr;
+        questStarterCount = 0;
+        questTitles = nullptr;
+        questTitleCount = 0;
+        questTexts = nullptr;
+        questTextCount = 0;
+
+        builtQuestStarters.clear();
+        builtQuestTitles.clear();
+        builtQuestTexts.clear();
+        snapshot.reset();
+    }
+
+    bool VoiceoverQuestIndex::LoadSnapshot(const std::string& fileName, uint64 contentHash)
+    {
+        std::unique_ptr<VoiceoverIndexSnapshot> newSnapshot = std::make_unique<VoiceoverIndexSnapshot>();
+        if (!newSnapshot->Open(fileName, contentHash))
+        {
+            return false;
+        }
+
+        size_t starterCount = 0;
+        size_t titleCount = 0;
+        size_t textCount = 0;
+        const QuestStarterRecord* starters = newSnapshot->GetSection<QuestStarterRecord>(SNAPSHOT_QUEST_STARTERS, starterCount);
+        const QuestTitleRecord* titles = newSnapshot->GetSection<QuestTitleRecord>(SNAPSHOT_QUEST_TITLES, titleCount);
+        const QuestTextRecord* texts = newSnapshot->GetSection<QuestTextRecord>(SNAPSHOT_QUEST_TEXTS, textCount);
+        if (!starters || !titles || !texts)
+        {
+            sLog.outError("Voiceover: index snapshot %s has no quest index", fileName.c_str());
+            return false;
+        }
+
+        Clear();
+        questStarters = starters;
+        questStarterCount = starterCount;
+        questTitles = titles;
+        questTitleCount = titleCount;
+        questTexts = texts;
+        questTextCount = textCount;
+        snapshot = std::move(newSnapshot);
+
+        sLog.outString(">> Voiceover: mapped %u quest starters, %u quest titles and %u quest texts from %s", (uint32)questStarterCount, (uint32)questTitleCount, (uint32)questTextCount, fileName.c_str());
+        return true;
+    }
+
+    bool VoiceoverQuestIndex::SaveSnapshot(const std::string& fileName, uint64 contentHash) const
+    {
+        const std::vector<VoiceoverIndexSnapshot::Section> sections =
+        {
+            { SNAPSHOT_QUEST_STARTERS, (uint32)sizeof(QuestStarterRecord), questStarters, questStarterCount },
+            { SNAPSHOT_QUEST_TITLES, (uint32)sizeof(QuestTitleRecord), questTitles, questTitleCount },
+            { SNAPSHOT_QUEST_TEXTS, (uint32)sizeof(QuestTextRecord), questTexts, questTextCount }
+        };
+
+        if (!VoiceoverIndexSnapshot::Write(fileName, contentHash, sections))
+        {
+            return false;
+        }
+
+        sLog.outString(">> Voiceover: wrote index snapshot %s", fileName.c_str());
+        return true;
+    }
+
+    uint64 VoiceoverQuestIndex::GetContentHash()
+    {
+        // The quest table is unordered so every quest is hashed on its own and the results summed,
+        // the relation tables and the item storage are walked in their sorted order
+        uint64 questsHash = 0;
+        for (const auto& [questId, quest] : sObjectMgr.GetQuestTemplates())
+        {
+            uint64 questHash = HashContent(HashContent(CONTENT_HASH_SEED, questId), quest->GetTitle());
+            for (uint8 textType = 0; textType < (uint8)QuestTextType::MAX; ++textType)
+            {
+                questHash = HashContent(questHash, GetQuestText(quest.get(), (QuestTextType)textType));
+            }
+
+            if (const QuestLocale* questLocale = sObjectMgr.GetQuestLocale(questId))
+            {
+                for (const std::string& localeTitle : questLocale->Title)
+                {
+                    questHash = HashContent(questHash, localeTitle);
+                }
+
+                for (uint8 textType = 0; textType < (uint8)QuestTextType::MAX; ++textType)
+                {
+                    for (const std::string& localeText : GetQuestLocaleTexts(questLocale, (QuestTextType)textType))
+                    {
+                        questHash = HashContent(questHash, localeText);
+                    }
+                }
+            }
+
+            questsHash += questHash;
+        }
+
+        uint64 hash = HashContent(CONTENT_HASH_SEED, &questsHash, sizeof(questsHash));
+        for (const auto* questRelations : { &sObjectMgr.GetCreatureQuestRelationsMap(), &sObjectMgr.GetCreatureQuestInvolvedRelationsMap(), &sObjectMgr.GetGOQuestRelationsMap(), &sObjectMgr.GetGOQuestInvolvedRelationsMap() })
+        {
+            hash = HashContent(hash, (uint32)questRelations->size());
+            for (const auto& [entry, questId] : *questRelations)
+            {
+                hash = HashContent(HashContent(hash, entry), questId);
+            }
+        }
+
+        for (SQLStorageBase::SQLSIterator<ItemPrototype> itr = sItemStorage.getDataBegin<ItemPrototype>(); itr < sItemStorage.getDataEnd<ItemPrototype>(); ++itr)
+        {
+            if (itr->StartQuest)
+            {
+                hash = HashContent(HashContent(hash, itr->ItemId), itr->StartQuest);
+            }
+        }
+
+        return hash;
+    }
+
+    const QuestStarter* VoiceoverQuestIndex::GetQuestStarter(uint32 questId) const
+    {
+        const QuestStarterRecord* end = questStarters + questStarterCount;
+        const QuestStarterRecord* record = std::lower_bound(questStarters, end, QuestStarterRecord{ questId, QuestStarter() });
+        return record != end && record->questId == questId ? &record->starter : nullptr;
+    }
+
+    uint32 VoiceoverQuestIndex::GetQuestIdByTitle(QuestRelationType relation, QuestStarterType giverType, uint32 giverEntry, int localeIndex, const std::string& title,
+        const TextFingerprint* fingerprint, QuestTextType textType, uint32* titleMatches) const
+    {
+        uint32 questId = 0;
+        uint32 matches = 0;
+        if (!title.empty())
+        {
+            // Quests without a localized title are only indexed under the default one
+            if (localeIndex >= 0 && localeIndex + 1 < MAX_TITLE_LOCALE_SLOTS)
+            {
+                questId = FindQuestIdByTitle(localeIndex + 1, relation, giverType, giverEntry, localeIndex, title, fingerprint, textType, matches);
+            }
+
+            if (questId == 0)
+            {
+                questId = FindQuestIdByTitle(0, relation, giverType, giverEntry, localeIndex, title, fingerprint, textType, matches);
+            }
+        }
+
+        if (titleMatches)
+        {
+            *titleMatches = matches;
+        }
+
+        return questId;
+    }
+
+    uint32 VoiceoverQuestIndex::FindQuestIdByTitle(uint8 localeSlot, QuestRelationType relation, QuestStarterType giverType, uint32 giverEntry, int localeIndex, const std::string& title,
+        const TextFingerprint* fingerprint, QuestTextType textType, uint32& titleMatches) const
+    {
+        const uint64 key = MakeTitleKey(localeSlot, relation, giverType, giverEntry, HashTitle(title));
+        const uint32 titleCheck = CheckTitle(title);
+        const QuestTitleRecord* end = questTitles + questTitleCount;
+
+        uint32 bestQuestId = 0;
+        float bestSimilarity = -1.0f;
+        titleMatches = 0;
+        for (const QuestTitleRecord* record = std::lower_bound(questTitles, end, QuestTitleRecord{ key, 0, 0 }); record != end && record->key == key; ++record)
+        {
+            // Guard against hash collisions. The sound events are resolved away from the world thread,
+            // where the quest templates can't be read as a .reload may be replacing them.
+            if (record->titleCheck != titleCheck)
+            {
+                continue;
+            }
+
+            titleMatches++;
+            if (!fingerprint)
+            {
+                bestQuestId = bestQuestId ? bestQuestId : record->questId;
+                continue;
+            }
+
+            const TextFingerprint* questText = GetQuestTextFingerprint(record->questId, textType, localeIndex);
+            const float similarity = questText ? GetTextSimilarity(*fingerprint, *questText) : 0.0f;
+            if (similarity > bestSimilarity)
+            {
+                bestQuestId = record->questId;
+                bestSimilarity = similarity;
+            }
+        }
+
+        return bestQuestId;
+    }
+
+    const TextFingerprint* VoiceoverQuestIndex::GetQuestTextFingerprint(uint32 questId, QuestTextType textType, int localeIndex) const
+    {
+        const QuestTextRecord* record = nullptr;
+        if (localeIndex >= 0 && localeIndex + 1 < MAX_TITLE_LOCALE_SLOTS)
+        {
+            record = FindQuestText(questId, textType, localeIndex + 1);
+        }
+
+        if (!record)
+        {
+            record = FindQuestText(questId, textType, 0);
+        }
+
+        return record ? &record->fingerprint : nullptr;
+    }
+
+    const VoiceoverQuestIndex::QuestTextRecord* VoiceoverQuestIndex::FindQuestText(uint32 questId, QuestTextType textType, uint8 localeSlot) const
+    {
+        QuestTextRecord key = {};
+        key.questId = questId;
+        key.textType = textType;
+        key.localeSlot = localeSlot;
+
+        const QuestTextRecord* end = questTexts + questTextCount;
+        const QuestTextRecord* record = std::lower_bound(questTexts, end, key);
+        return record != end && record->questId == questId && record->textType == textType && record->localeSlot == localeSlot ? record : nullptr;
+    }
+
+    void VoiceoverQuestIndex::AddQuestTexts(const std::vector<QuestTitleRecord>& titles)
+    {
+        // Only the quests a giver has several of under one title key need their texts to tell them apart
+        std::vector<uint32> questIds;
+        for (size_t i = 1; i < titles.size(); ++i)
+        {
+            if (titles[i].key == titles[i - 1].key)
+            {
+                questIds.push_back(titles[i - 1].questId);
+                questIds.push_back(titles[i].questId);
+            }
+        }
+
+        std::sort(questIds.begin(), questIds.end());
+        questIds.erase(std::unique(questIds.begin(), questIds.end()), questIds.end());
+
+        const auto addQuestText = [this](uint32 questId, QuestTextType textType, uint8 localeSlot, const std::string& text)
+        {
+            QuestTextRecord record = {};
+            record.questId = questId;
+            record.textType = textType;
+            record.localeSlot = localeSlot;
+            record.fingerprint = MakeTextFingerprint(text);
+            builtQuestTexts.push_back(record);
+        };
+
+        for (uint32 questId : questIds)
+        {
+            const Quest* quest = sObjectMgr.GetQuestTemplate(questId);
+            const QuestLocale* questLocale = sObjectMgr.GetQuestLocale(questId);
+            for (uint8 textType = 0; textType < (uint8)QuestTextType::MAX; ++textType)
+            {
+                const std::string& text = GetQuestText(quest, (QuestTextType)textType);
+                if (!text.empty())
+                {
+                    addQuestText(questId, (QuestTextType)textType, 0, text);
+                }
+
+                if (questLocale)
+                {
+                    const std::vector<std::string>& localeTexts = GetQuestLocaleTexts(questLocale, (QuestTextType)textType);
+                    for (size_t localeIndex = 0; localeIndex < localeTexts.size() && localeIndex + 1 < MAX_TITLE_LOCALE_SLOTS; ++localeIndex)
+                    {
+                        if (!localeTexts[localeIndex].empty())
+                        {
+                            addQuestText(questId, (QuestTextType)textType, localeIndex + 1, localeTexts[localeIndex]);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Added in quest id, text type and locale order already
+        builtQuestTexts.shrink_to_fit();
+    }
+
+    template<class QuestRelations>
+    void VoiceoverQuestIndex::AddQuestTitles(std::vector<QuestTitleRecord>& titles, QuestRelationType relation, QuestStarterType giverType, const QuestRelations& questRelations)
+    {
+        for (const auto& [giverEntry, questId] : questRelations)
+        {
+            if (const Quest* quest = sObjectMgr.GetQuestTemplate(questId))
+            {
+                titles.push_back({ MakeTitleKey(0, relation, giverType, giverEntry, HashTitle(quest->GetTitle())), questId, CheckTitle(quest->GetTitle()) });
+
+                if (const QuestLocale* questLocale = sObjectMgr.GetQuestLocale(questId))
+                {
+                    for (size_t localeIndex = 0; localeIndex < questLocale->Title.size() && localeIndex + 1 < MAX_TITLE_LOCALE_SLOTS; ++localeIndex)
+                    {
+                        const std::string& localeTitle = questLocale->Title[localeIndex];
+                        if (!localeTitle.empty())
+                        {
+                            titles.push_back({ MakeTitleKey(localeIndex + 1, relation, giverType, giverEntry, HashTitle(localeTitle)), questId, CheckTitle(localeTitle) });
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    uint64 VoiceoverQuestIndex::MakeTitleKey(uint8 localeSlot, QuestRelationType relation, QuestStarterType giverType, uint32 giverEntry, uint32 titleHash)
+    {
+        // [locale:5][relation:1][giver type:2][giver entry:24][title hash:32]
+        return ((uint64)(localeSlot & 0x1F) << 59) |
+               ((uint64)((uint8)relation & 0x1) << 58) |
+               ((uint64)((uint8)giverType & 0x3) << 56) |
+               ((uint64)(giverEntry & 0xFFFFFF) << 32) |
+               (uint64)titleHash;
+    }
+
+    const std::string& VoiceoverQuestIndex::GetQuestTitle(const Quest* quest, int localeIndex)
+    {
+        if (localeIndex >= 0)
+        {
+            if (const QuestLocale* questLocale = sObjectMgr.GetQuestLocale(quest->GetQuestId()))
+            {
+                if (questLocale->Title.size() > (size_t)localeIndex && !questLocale->Title[localeIndex].empty())
+                {
+                    return questLocale->Title[localeIndex];
+                }
+            }
+        }
+
+        return quest->GetTitle();
+    }
+
+    uint32 VoiceoverQuestIndex::HashTitle(const std::string& title)
+    {
+        return HashTitle(title.data(), title.size());
+    }
+
+    uint32 VoiceoverQuestIndex::HashTitle(const char* title, size_t length)
+    {
+        // The localized titles are UTF-8, they are folded character by character
+        return HashFoldedText(std::string_view(title, length));
+    }
+
+    uint32 VoiceoverQuestIndex::CheckTitle(const std::string& title)
+    {
+        return HashFoldedText(title, TITLE_CHECK_SEED);
+    }
+
+    bool VoiceoverQuestIndex::IsSameTitle(const std::string& a, const std::string& b)
+    {
+        return IsSameFoldedText(a, b);
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_QUEST_INDEX_H
+#define CMANGOS_MODULE_VOICEOVER_QUEST_INDEX_H
+
+#include "VoiceoverTextFingerprint.h"
+
+#include "Platform/Define.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class Quest;
+
+namespace cmangos_module
+{
+    class VoiceoverIndexSnapshot;
+
+    enum class QuestStarterType : uint8
+    {
+        NONE = 0,
+        CREATURE = 1,
+        GAMEOBJECT = 2,
+        ITEM = 3
+    };
+
+    enum class QuestRelationType : uint8
+    {
+        STARTER = 0,
+        ENDER = 1
+    };
+
+    // Stored as is in the index snapshot, the explicit padding keeps it free of uninitialized bytes
+    struct QuestStarter
+    {
+        QuestStarterType type = QuestStarterType::NONE;
+        uint8 padding[3] = {};
+        uint32 entry = 0;
+    };
+
+    // Read-only quest lookups built once from the ObjectMgr tables so the
+    // chat handlers don't have to scan the relation maps on every request.
+    // The lookups are flat sorted arrays, either built here or mapped from a snapshot file.
+    class VoiceoverQuestIndex
+    {
+    public:
+        VoiceoverQuestIndex();
+        ~VoiceoverQuestIndex();
+
+        // The relation tables are indexed in parallel
+        void Build();
+        void Clear();
+
+        // Uses the index stored in the snapshot file if it was built from the same ObjectMgr data
+        bool LoadSnapshot(const std::string& fileName, uint64 contentHash);
+        bool SaveSnapshot(const std::string& fileName, uint64 contentHash) const;
+        bool IsSnapshotLoaded() const { return snapshot != nullptr; }
+
+        // Hash of the ObjectMgr data the index is built from
+        static uint64 GetContentHash();
+
+        const QuestStarter* GetQuestStarter(uint32 questId) const;
+        size_t GetQuestStarterCount() const { return questStarterCount; }
+
+        // Finds the quest a giver starts or ends by its (case insensitive) title as shown in the given locale.
+        // When the giver has several quests with that title, the one whose text of the given type is the
+        // most similar to the fingerprint wins, or the first one without a fingerprint. titleMatches is
+        // set to the number of quests that had the title.
+        uint32 GetQuestIdByTitle(QuestRelationType relation, QuestStarterType giverType, uint32 giverEntry, int localeIndex, const std::string& title,
+            const TextFingerprint* fingerprint = nullptr, QuestTextType textType = QuestTextType::DETAILS, uint32* titleMatches = nullptr) const;
+        size_t GetQuestTitleCount() const { return questTitleCount; }
+
+        // Only the quests sharing a title with another quest of the same giver have their texts fingerprinted
+        const TextFingerprint* GetQuestTextFingerprint(uint32 questId, QuestTextType textType, int localeIndex) const;
+        size_t GetQuestTextCount() const { return questTextCount; }
+
+        static const std::string& GetQuestTitle(const Quest* quest, int localeIndex);
+
+        // Case insensitive for the UTF-8 titles of every locale, see VoiceoverCaseFold.h
+        static uint32 HashTitle(const std::string& title);
+        static uint32 HashTitle(const char* title, size_t length);
+        static uint32 CheckTitle(const std::string& title);
+        static bool IsSameTitle(const std::string& a, const std::string& b);
+
+    private:
+        // Snapshot records, their layout is part of the snapshot format version
+        struct QuestStarterRecord
+        {
+            uint32 questId;
+            QuestStarter starter;
+
+            bool operator<(const QuestStarterRecord& other) const { return questId < other.questId; }
+        };
+
+        struct QuestTitleRecord
+        {
+            uint64 key;
+            uint32 questId;
+            // Second hash of the title, which tells apart the titles sharing a key without the quest templates
+            uint32 titleCheck;
+
+            bool operator<(const QuestTitleRecord& other) const { return key < other.key || (key == other.key && questId < other.questId); }
+        };
+
+        struct QuestTextRecord
+        {
+            uint32 questId;
+            QuestTextType textType;
+            uint8 localeSlot;
+            uint8 padding[2];
+            TextFingerprint fingerprint;
+
+            bool operator<(const QuestTextRecord& other) const
+            {
+                return questId != other.questId ? questId < other.questId : (textType != other.textType ? textType < other.textType : localeSlot < other.localeSlot);
+            }
+        };
+
+        template<class QuestRelations>
+        static void AddQuestTitles(std::vector<QuestTitleRecord>& titles, QuestRelationType relation, QuestStarterType giverType, const QuestRelations& questRelations);
+        void AddQuestTexts(const std::vector<QuestTitleRecord>& titles);
+        uint32 FindQuestIdByTitle(uint8 localeSlot, QuestRelationType relation, QuestStarterType giverType, uint32 giverEntry, int localeIndex, const std::string& title,
+            const TextFingerprint* fingerprint, QuestTextType textType, uint32& titleMatches) const;
+        const QuestTextRecord* FindQuestText(uint32 questId, QuestTextType textType, uint8 localeSlot) const;
+
+        static uint64 MakeTitleKey(uint8 localeSlot, QuestRelationType relation, QuestStarterType giverType, uint32 giverEntry, uint32 titleHash);
+
+    private:
+        // Sorted by quest id, by title key and by quest id, text type and locale
+        const QuestStarterRecord* questStarters = nullptr;
+        size_t questStarterCount = 0;
+        const QuestTitleRecord* questTitles = nullptr;
+        size_t questTitleCount = 0;
+        const QuestTextRecord* questTexts = nullptr;
+        size_t questTextCount = 0;
+
+        // Owns the records above when the index was built rather than mapped
+        std::vector<QuestStarterRecord> builtQuestStarters;
+        std::vector<QuestTitleRecord> builtQuestTitles;
+        std::vector<QuestTextRecord> builtQuestTexts;
+        std::unique_ptr<VoiceoverIndexSnapshot> snapshot;
+    };
+}
+#endif
@@ -0,0 +1,137 @@
+#include "VoiceoverTextFingerprint.h"
+
+#include <bitset>
+
+namespace cmangos_module
+{
+    // 2^24 divided by the golden ratio
+    constexpr uint32 FINGERPRINT_HASH_MULTIPLIER = 10368889;
+
+    // Lua's %s and %p in the C locale, bytes of multibyte characters are part of the words
+    bool IsWordSeparator(unsigned char c)
+    {
+        return c < 0x80 && (c <= ' ' || c == 0x7F || (c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~'));
+    }
+
+    // Length of the placeholder at the position: $ and a letter ($N, $C, $R, $B), or the whole $Gmale:female;
+    // choice. The rest of the word after it is kept, the addon hashes it as the text the placeholder became.
+    size_t GetPlaceholderLength(const std::string& text, size_t i)
+    {
+        if (text[i] != '$' || i + 1 >= text.size())
+        {
+            return 0;
+        }
+
+        const char c = text[i + 1];
+        if (c == 'G' || c == 'g')
+        {
+            const size_t end = text.find(';', i + 2);
+            return end != std::string::npos ? end + 1 - i : 2;
+        }
+
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ? 2 : 0;
+    }
+
+    bool TextFingerprint::IsEmpty() const
+    {
+        uint64 bits = 0;
+        for (uint64 word : words)
+        {
+            bits |= word;
+        }
+
+        return bits == 0;
+    }
+
+    TextFingerprint MakeTextFingerprint(const std::string& text)
+    {
+        TextFingerprint fingerprint;
+        size_t i = 0;
+        while (i < text.size())
+        {
+            if (const size_t placeholderLength = GetPlaceholderLength(text, i))
+            {
+                i += placeholderLength;
+                continue;
+            }
+
+            if (IsWordSeparator(text[i]))
+            {
+                ++i;
+                continue;
+            }
+
+            // 24 bit hash of the word, spread by a multiplication (Fibonacci hashing) so the short words
+            // don't all end up in the low bits. The top 8 bits pick the bit to set. The addon does the same
+            // in plain Lua arithmetic, which has no bitwise operators, so nothing here may go over 2^53.
+            uint32 hash = 0;
+            for (; i < text.size() && !IsWordSeparator(text[i]); ++i)
+            {
+                unsigned char c = text[i];
+                if (c >= 'A' && c <= 'Z')
+                {
+                    c += 'a' - 'A';
+                }
+
+                hash = (hash * 31 + c) & 0xFFFFFF;
+            }
+
+            const uint32 bit = ((hash * FINGERPRINT_HASH_MULTIPLIER) & 0xFFFFFF) >> 16;
+            fingerprint.words[bit / 64] |= 1ull << (bit % 64);
+        }
+
+        return fingerprint;
+    }
+
+    bool ParseTextFingerprint(std::string_view hex, TextFingerprint& fingerprint)
+    {
+        fingerprint = TextFingerprint();
+        if (hex.size() != TEXT_FINGERPRINT_BITS / 4)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < hex.size(); ++i)
+        {
+            const char c = hex[i];
+            uint64 digit;
+            if (c >= '0' && c <= '9')
+            {
+                digit = c - '0';
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                digit = c - 'a' + 10;
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                digit = c - 'A' + 10;
+            }
+            else
+            {
+                fingerprint = TextFingerprint();
+                return false;
+            }
+
+            // Every pair of digits is a byte, the high digit first
+            const size_t bit = (i / 2) * 8 + (i % 2 == 0 ? 4 : 0);
+            fingerprint.words[bit / 64] |= digit << (bit % 64);
+        }
+
+        return true;
+    }
+
+    float GetTextSimilarity(const TextFingerprint& a, const TextFingerprint& b)
+    {
+        // A fixed number of words, the compiler unrolls it to popcounts when the target has them
+        size_t common = 0;
+        size_t all = 0;
+        for (uint32 i = 0; i < TEXT_FINGERPRINT_WORDS; ++i)
+        {
+            common += std::bitset<64>(a.words[i] & b.words[i]).count();
+            all += std::bitset<64>(a.words[i] | b.words[i]).count();
+        }
+
+        return all > 0 ? (float)common / (float)all : 0.0f;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_TEXT_FINGERPRINT_H
+#define CMANGOS_MODULE_VOICEOVER_TEXT_FINGERPRINT_H
+
+#include "Platform/Define.h"
+
+#include <string>
+#include <string_view>
+
+namespace cmangos_module
+{
+    constexpr uint32 TEXT_FINGERPRINT_BITS = 256;
+    constexpr uint32 TEXT_FINGERPRINT_WORDS = TEXT_FINGERPRINT_BITS / 64;
+
+    // The quest frame texts a fingerprint can be taken from
+    enum class QuestTextType : uint8
+    {
+        DETAILS = 0,
+        REQUEST_ITEMS = 1,
+        OFFER_REWARD = 2,
+        MAX
+    };
+
+    // The words of a text as a set of bits, every word sets one of them. Stored as is in the index snapshot.
+    struct TextFingerprint
+    {
+        uint64 words[TEXT_FINGERPRINT_WORDS] = {};
+
+        bool IsEmpty() const;
+    };
+
+    // Words are the runs of characters between ASCII spaces and punctuation, with their ASCII letters
+    // lowercased. They must be hashed exactly like the addon does it, which has no other case mapping.
+    // The $N, $C, $B, $Gmale:female; ... placeholders of the quest texts are skipped as the addon gets them
+    // replaced, the text right after one is still hashed ("$B$BYou" as "you").
+    TextFingerprint MakeTextFingerprint(const std::string& text);
+
+    // 64 hex digits, the first two are the bits 0 to 7. False if the text isn't one.
+    bool ParseTextFingerprint(std::string_view hex, TextFingerprint& fingerprint);
+
+    // Share of the words the texts have in common (Jaccard index), from 0 to 1
+    float GetTextSimilarity(const TextFingerprint& a, const TextFingerprint& b);
+}
+#endif
@@ -0,0 +1,198 @@
+#include "VoiceoverTrace.h"
+
+#include "Entities/Player.h"
+
+#include "Log/Log.h"
+
+#include <cstring>
+
+namespace cmangos_module
+{
+    constexpr char TRACE_MAGIC[8] = { 'V', 'O', 'T', 'R', 'A', 'C', 'E', '\0' };
+    constexpr uint32 TRACE_VERSION = 1;
+
+    // Records are buffered and written in blocks of about this size
+    constexpr size_t TRACE_BUFFER_SIZE = 64 * 1024;
+
+    // Longest args the reader accepts, chat commands are far shorter
+    constexpr uint64 MAX_TRACE_ARGS_LENGTH = 4096;
+
+    void AppendVarint(std::string& buffer, uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            buffer.push_back((char)(value | 0x80));
+            value >>= 7;
+        }
+
+        buffer.push_back((char)value);
+    }
+
+    bool ReadVarint(std::istream& stream, uint64& value)
+    {
+        value = 0;
+        for (uint32 shift = 0; shift < 64; shift += 7)
+        {
+            const int byte = stream.get();
+            if (byte == EOF)
+            {
+                return false;
+            }
+
+            value |= (uint64)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool VoiceoverTraceRecorder::Start(const std::string& fileName)
+    {
+        Stop();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        file.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            sLog.outError("Voiceover: can't open trace file %s", fileName.c_str());
+            return false;
+        }
+
+        const uint32 version = TRACE_VERSION;
+        file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+
+        buffer.clear();
+        buffer.reserve(TRACE_BUFFER_SIZE + MAX_TRACE_ARGS_LENGTH);
+        startTime = std::chrono::steady_clock::now();
+        lastTime = 0;
+        recordCount = 0;
+        recording.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint64 VoiceoverTraceRecorder::Stop()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!file.is_open())
+        {
+            return 0;
+        }
+
+        recording.store(false, std::memory_order_relaxed);
+        Flush();
+        file.close();
+        return recordCount;
+    }
+
+    void VoiceoverTraceRecorder::Record(AddonCommand command, const Player* player, std::string_view args)
+    {
+        if (!IsRecording() || !player)
+        {
+            return;
+        }
+
+        TraceRecord record;
+        record.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+        record.playerId = player->GetObjectGuid().GetCounter();
+        record.localeIndex = player->GetSession()->GetSessionDbLocaleIndex();
+        record.command = command;
+        record.targetGuid = player->GetSelectionGuid().GetRawValue();
+        record.args = args;
+        Write(record);
+    }
+
+    void VoiceoverTraceRecorder::Write(const TraceRecord& record)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!file.is_open())
+        {
+            return;
+        }
+
+        // Records from several threads can arrive slightly out of order
+        const uint64 time = std::max(record.time, lastTime);
+        const size_t argsLength = std::min<size_t>(record.args.size(), MAX_TRACE_ARGS_LENGTH);
+
+        AppendVarint(buffer, time - lastTime);
+        AppendVarint(buffer, record.playerId);
+        buffer.push_back((char)record.command);
+        buffer.push_back((char)(uint8)(record.localeIndex + 1));
+        AppendVarint(buffer, record.targetGuid);
+        AppendVarint(buffer, argsLength);
+        buffer.append(record.args, 0, argsLength);
+
+        lastTime = time;
+        recordCount++;
+
+        if (buffer.size() >= TRACE_BUFFER_SIZE)
+        {
+            Flush();
+        }
+    }
+
+    void VoiceoverTraceRecorder::Flush()
+    {
+        file.write(buffer.data(), buffer.size());
+        file.flush();
+        buffer.clear();
+    }
+
+    bool VoiceoverTraceReader::Open(const std::string& fileName)
+    {
+        file.open(fileName, std::ios::binary);
+        if (!file.is_open())
+        {
+            sLog.outError("Voiceover: can't open trace file %s", fileName.c_str());
+            return false;
+        }
+
+        char magic[sizeof(TRACE_MAGIC)];
+        uint32 version = 0;
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (!file || memcmp(magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || version != TRACE_VERSION)
+        {
+            sLog.outError("Voiceover: %s is not a trace file of version %u", fileName.c_str(), TRACE_VERSION);
+            file.close();
+            return false;
+        }
+
+        lastTime = 0;
+        return true;
+    }
+
+    bool VoiceoverTraceReader::Next(TraceRecord& record)
+    {
+        uint64 timeDelta, playerId, targetGuid, argsLength;
+        if (!file.is_open() || !ReadVarint(file, timeDelta) || !ReadVarint(file, playerId))
+        {
+            return false;
+        }
+
+        const int command = file.get();
+        const int locale = file.get();
+        if (command == EOF || locale == EOF || !ReadVarint(file, targetGuid) || !ReadVarint(file, argsLength) || argsLength > MAX_TRACE_ARGS_LENGTH)
+        {
+            return false;
+        }
+
+        record.args.resize((size_t)argsLength);
+        file.read(&record.args[0], (std::streamsize)argsLength);
+        if (!file)
+        {
+            return false;
+        }
+
+        lastTime += timeDelta;
+        record.time = lastTime;
+        record.playerId = (uint32)playerId;
+        record.command = command > 0 && command < (int)AddonCommand::MAX ? (AddonCommand)command : AddonCommand::NONE;
+        record.localeIndex = locale - 1;
+        record.targetGuid = targetGuid;
+        return true;
+    }
+}
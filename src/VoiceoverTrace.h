@@ -0,0 +1,79 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_TRACE_H
+#define CMANGOS_MODULE_VOICEOVER_TRACE_H
+
+#include "VoiceoverAddonCommand.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+class Player;
+
+namespace cmangos_module
+{
+    // One addon command as it reached the chat command handler
+    struct TraceRecord
+    {
+        // Microseconds since the recording started
+        uint64 time = 0;
+        uint32 playerId = 0;
+        int localeIndex = -1;
+        AddonCommand command = AddonCommand::NONE;
+        // What the player had selected, sound events resolve quests through it
+        uint64 targetGuid = 0;
+        std::string args;
+    };
+
+    // Writes the addon commands received by the module to a trace file that bench/voiceover_replay
+    // plays back. The file starts with an 8 byte magic and a version, every record is then
+    // [time delta][player id][command][locale + 1][target guid][args length][args] with the
+    // numbers as little endian base 128 varints.
+    class VoiceoverTraceRecorder
+    {
+    public:
+        VoiceoverTraceRecorder() = default;
+        VoiceoverTraceRecorder(const VoiceoverTraceRecorder&) = delete;
+        VoiceoverTraceRecorder& operator=(const VoiceoverTraceRecorder&) = delete;
+        ~VoiceoverTraceRecorder() { Stop(); }
+
+        bool Start(const std::string& fileName);
+
+        // Returns the number of records written
+        uint64 Stop();
+
+        bool IsRecording() const { return recording.load(std::memory_order_relaxed); }
+        void Record(AddonCommand command, const Player* player, std::string_view args);
+
+        // Appends a record with the given time, for traces that weren't recorded from a live server
+        void Write(const TraceRecord& record);
+
+    private:
+        void Flush();
+
+    private:
+        std::atomic<bool> recording{ false };
+        std::mutex mutex;
+        std::ofstream file;
+        std::string buffer;
+        std::chrono::steady_clock::time_point startTime;
+        uint64 lastTime = 0;
+        uint64 recordCount = 0;
+    };
+
+    class VoiceoverTraceReader
+    {
+    public:
+        bool Open(const std::string& fileName);
+
+        // False once the end of the file (or a truncated record) is reached
+        bool Next(TraceRecord& record);
+
+    private:
+        std::ifstream file;
+        uint64 lastTime = 0;
+    };
+}
+#endif
@@ -0,0 +1,166 @@
+#include "VoiceoverVoiceManifest.h"
+
+#include "Log/Log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+namespace cmangos_module
+{
+    bool VoiceoverVoiceManifest::Load(const std::string& fileName)
+    {
+        Clear();
+
+        std::ifstream file(fileName);
+        if (!file.is_open())
+        {
+            sLog.outError("Voiceover: can't open voice manifest file %s", fileName.c_str());
+            return false;
+        }
+
+        // Every line is "line\tkey\tseconds" where the line is accept, progress, complete (keyed
+        // by quest id) or gossip (keyed by sound hash), lines starting with # are comments
+        uint32 invalidLines = 0;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+
+            const size_t typeEnd = line.find('\t');
+            const size_t keyEnd = typeEnd != std::string::npos ? line.find('\t', typeEnd + 1) : std::string::npos;
+            if (keyEnd == std::string::npos || keyEnd == typeEnd + 1)
+            {
+                invalidLines++;
+                continue;
+            }
+
+            const std::string type = line.substr(0, typeEnd);
+            const std::string key = line.substr(typeEnd + 1, keyEnd - typeEnd - 1);
+            const double seconds = strtod(line.c_str() + keyEnd + 1, nullptr);
+            const uint32 duration = seconds > 0.0 ? (uint32)(seconds * 1000.0 + 0.5) : 0;
+
+            if (type == "gossip")
+            {
+                gossipLines.push_back({ HashGossip(key), duration });
+                continue;
+            }
+
+            const VoicedQuestLine questLine = type == "accept" ? VoicedQuestLine::ACCEPT : type == "progress" ? VoicedQuestLine::PROGRESS : type == "complete" ? VoicedQuestLine::COMPLETE : VoicedQuestLine::MAX;
+            const uint32 questId = (uint32)strtoul(key.c_str(), nullptr, 10);
+            if (questLine == VoicedQuestLine::MAX || questId == 0)
+            {
+                invalidLines++;
+                continue;
+            }
+
+            questLines[(uint8)questLine].push_back({ questId, duration });
+        }
+
+        for (std::vector<VoicedLine>& lines : questLines)
+        {
+            SortLines(lines);
+        }
+
+        SortLines(gossipLines);
+        loaded = true;
+
+        if (invalidLines > 0)
+        {
+            sLog.outError("Voiceover: skipped %u invalid lines in voice manifest file %s", invalidLines, fileName.c_str());
+        }
+
+        sLog.outString(">> Voiceover: voice manifest lists %u quest lines and %u gossip lines", (uint32)GetQuestLineCount(), (uint32)gossipLines.size());
+        return true;
+    }
+
+    void VoiceoverVoiceManifest::Clear()
+    {
+        for (std::vector<VoicedLine>& lines : questLines)
+        {
+            lines.clear();
+        }
+
+        gossipLines.clear();
+        loaded = false;
+    }
+
+    bool VoiceoverVoiceManifest::IsQuestVoiced(uint32 questId) const
+    {
+        return !loaded ||
+               FindLine(questLines[(uint8)VoicedQuestLine::ACCEPT], questId) ||
+               FindLine(questLines[(uint8)VoicedQuestLine::PROGRESS], questId) ||
+               FindLine(questLines[(uint8)VoicedQuestLine::COMPLETE], questId);
+    }
+
+    bool VoiceoverVoiceManifest::IsQuestLineVoiced(VoicedQuestLine line, uint32 questId) const
+    {
+        return !loaded || (line < VoicedQuestLine::MAX && FindLine(questLines[(uint8)line], questId));
+    }
+
+    bool VoiceoverVoiceManifest::IsGossipVoiced(const std::string& hash) const
+    {
+        return !loaded || FindLine(gossipLines, HashGossip(hash));
+    }
+
+    uint32 VoiceoverVoiceManifest::GetQuestLineDuration(VoicedQuestLine line, uint32 questId) const
+    {
+        const VoicedLine* voicedLine = line < VoicedQuestLine::MAX ? FindLine(questLines[(uint8)line], questId) : nullptr;
+        return voicedLine ? voicedLine->duration : 0;
+    }
+
+    uint32 VoiceoverVoiceManifest::GetGossipDuration(const std::string& hash) const
+    {
+        const VoicedLine* voicedLine = FindLine(gossipLines, HashGossip(hash));
+        return voicedLine ? voicedLine->duration : 0;
+    }
+
+    size_t VoiceoverVoiceManifest::GetQuestLineCount() const
+    {
+        size_t count = 0;
+        for (const std::vector<VoicedLine>& lines : questLines)
+        {
+            count += lines.size();
+        }
+
+        return count;
+    }
+
+    void VoiceoverVoiceManifest::SortLines(std::vector<VoicedLine>& lines)
+    {
+        // A line recorded for several npcs or genders is listed once with its longest recording
+        std::sort(lines.begin(), lines.end(), [](const VoicedLine& a, const VoicedLine& b)
+        {
+            return a.key < b.key || (a.key == b.key && a.duration > b.duration);
+        });
+
+        lines.erase(std::unique(lines.begin(), lines.end(), [](const VoicedLine& a, const VoicedLine& b) { return a.key == b.key; }), lines.end());
+        lines.shrink_to_fit();
+    }
+
+    const VoiceoverVoiceManifest::VoicedLine* VoiceoverVoiceManifest::FindLine(const std::vector<VoicedLine>& lines, uint64 key)
+    {
+        auto lineIt = std::lower_bound(lines.begin(), lines.end(), VoicedLine{ key, 0 });
+        return lineIt != lines.end() && lineIt->key == key ? &*lineIt : nullptr;
+    }
+
+    uint64 VoiceoverVoiceManifest::HashGossip(const std::string& hash)
+    {
+        // 64 bit FNV-1a, the sound hashes themselves are too long to be worth keeping
+        uint64 result = 14695981039346656037ull;
+        for (const char c : hash)
+        {
+            result = (result ^ (uint8)c) * 1099511628211ull;
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_VOICE_MANIFEST_H
+#define CMANGOS_MODULE_VOICEOVER_VOICE_MANIFEST_H
+
+#include "Platform/Define.h"
+
+#include <string>
+#include <vector>
+
+namespace cmangos_module
+{
+    enum class VoicedQuestLine : uint8
+    {
+        ACCEPT = 0,
+        PROGRESS = 1,
+        COMPLETE = 2,
+        MAX
+    };
+
+    // Quest and gossip lines the installed voice packs have a sound for, loaded from the
+    // manifest exported from the addon data modules (see tools/export_voice_manifest.py).
+    // Without a manifest every line is considered voiced.
+    class VoiceoverVoiceManifest
+    {
+    public:
+        bool Load(const std::string& fileName);
+        void Clear();
+        bool IsLoaded() const { return loaded; }
+
+        bool IsQuestVoiced(uint32 questId) const;
+        bool IsQuestLineVoiced(VoicedQuestLine line, uint32 questId) const;
+        bool IsGossipVoiced(const std::string& hash) const;
+
+        // Length of the longest recording of the line in milliseconds, 0 if unknown
+        uint32 GetQuestLineDuration(VoicedQuestLine line, uint32 questId) const;
+        uint32 GetGossipDuration(const std::string& hash) const;
+
+        size_t GetQuestLineCount() const;
+        size_t GetGossipLineCount() const { return gossipLines.size(); }
+
+    private:
+        struct VoicedLine
+        {
+            uint64 key;
+            uint32 duration;
+
+            bool operator<(const VoicedLine& other) const { return key < other.key; }
+        };
+
+        static void SortLines(std::vector<VoicedLine>& lines);
+        static const VoicedLine* FindLine(const std::vector<VoicedLine>& lines, uint64 key);
+        static uint64 HashGossip(const std::string& hash);
+
+    private:
+        // Sorted by quest id or gossip hash so a line is found with a binary search
+        std::vector<VoicedLine> questLines[(uint8)VoicedQuestLine::MAX];
+        std::vector<VoicedLine> gossipLines;
+        bool loaded = false;
+    };
+}
+#endif
@@ -0,0 +1,75 @@
+#include "VoiceoverWorkerPool.h"
+
+namespace cmangos_module
+{
+    void VoiceoverWorkerPool::Start(uint32 threadCount)
+    {
+        Stop();
+
+        stopping = false;
+        workers.reserve(threadCount);
+        for (uint32 i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back(&VoiceoverWorkerPool::Run, this);
+        }
+    }
+
+    void VoiceoverWorkerPool::Stop()
+    {
+        if (workers.empty())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        condition.notify_all();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        workers.clear();
+    }
+
+    void VoiceoverWorkerPool::Enqueue(std::function<void()>&& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+
+        condition.notify_one();
+    }
+
+    size_t VoiceoverWorkerPool::GetQueuedJobs() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return jobs.size();
+    }
+
+    void VoiceoverWorkerPool::Run()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                {
+                    return;
+                }
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            job();
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_WORKER_POOL_H
+#define CMANGOS_MODULE_VOICEOVER_WORKER_POOL_H
+
+#include "Platform/Define.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cmangos_module
+{
+    // Fixed set of threads running the jobs queued from the world and session updates.
+    // Jobs must only read shared data that can't change under them and hand their
+    // results back through a completion queue.
+    class VoiceoverWorkerPool
+    {
+    public:
+        VoiceoverWorkerPool() = default;
+        VoiceoverWorkerPool(const VoiceoverWorkerPool&) = delete;
+        VoiceoverWorkerPool& operator=(const VoiceoverWorkerPool&) = delete;
+        ~VoiceoverWorkerPool() { Stop(); }
+
+        void Start(uint32 threadCount);
+
+        // Waits for the queued jobs to finish before joining the threads
+        void Stop();
+
+        bool IsRunning() const { return !workers.empty(); }
+        void Enqueue(std::function<void()>&& job);
+
+        // Jobs no worker picked up yet
+        size_t GetQueuedJobs() const;
+
+    private:
+        void Run();
+
+    private:
+        std::vector<std::thread> workers;
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::function<void()>> jobs;
+        bool stopping = false;
+    };
+}
+#endif
@@ -0,0 +1,185 @@
+#include "VoiceoverZoneIndex.h"
+#include "VoiceoverPayloadCache.h"
+#include "VoiceoverVoiceManifest.h"
+
+#include "Globals/ObjectMgr.h"
+#include "Log/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace cmangos_module
+{
+    constexpr char ZONE_QUEST_HINT_SEPARATOR = '^';
+
+    void VoiceoverZoneIndex::Build(const VoiceoverQuestIndex& questIndex, const VoiceoverVoiceManifest& voiceManifest)
+    {
+        zoneQuests.clear();
+        zoneCount = 0;
+        encodedHints.clear();
+
+        // The first ender found wins, creatures take priority over gameobjects like the starters
+        std::unordered_map<uint32, QuestStarter> questEnders;
+        const auto addQuestEnder = [&questEnders](uint32 questId, QuestStarterType type, uint32 entry)
+        {
+            QuestStarter ender;
+            ender.type = type;
+            ender.entry = entry;
+            questEnders.emplace(questId, ender);
+        };
+
+        for (const auto& [entry, questId] : sObjectMgr.GetCreatureQuestInvolvedRelationsMap())
+        {
+            addQuestEnder(questId, QuestStarterType::CREATURE, entry);
+        }
+
+        for (const auto& [entry, questId] : sObjectMgr.GetGOQuestInvolvedRelationsMap())
+        {
+            addQuestEnder(questId, QuestStarterType::GAMEOBJECT, entry);
+        }
+
+        for (const auto& [questId, quest] : sObjectMgr.GetQuestTemplates())
+        {
+            // Negative values are quest sorts (class, profession, holiday...) rather than places
+            if (quest->GetZoneOrSort() <= 0)
+            {
+                continue;
+            }
+
+            if (!voiceManifest.IsQuestLineVoiced(VoicedQuestLine::ACCEPT, questId) &&
+                !voiceManifest.IsQuestLineVoiced(VoicedQuestLine::PROGRESS, questId) &&
+                !voiceManifest.IsQuestLineVoiced(VoicedQuestLine::COMPLETE, questId))
+            {
+                continue;
+            }
+
+            ZoneQuest zoneQuest;
+            zoneQuest.zoneId = (uint32)quest->GetZoneOrSort();
+            zoneQuest.questId = questId;
+            if (const QuestStarter* starter = questIndex.GetQuestStarter(questId))
+            {
+                zoneQuest.starter = *starter;
+            }
+
+            auto enderIt = questEnders.find(questId);
+            if (enderIt != questEnders.end())
+            {
+                zoneQuest.ender = enderIt->second;
+            }
+
+            // Quests nobody gives or takes can't be found from a dialog
+            if (zoneQuest.starter.type != QuestStarterType::NONE || zoneQuest.ender.type != QuestStarterType::NONE)
+            {
+                zoneQuests.push_back(zoneQuest);
+            }
+        }
+
+        std::sort(zoneQuests.begin(), zoneQuests.end());
+        zoneQuests.shrink_to_fit();
+        for (size_t i = 0; i < zoneQuests.size(); ++i)
+        {
+            if (i == 0 || zoneQuests[i].zoneId != zoneQuests[i - 1].zoneId)
+            {
+                zoneCount++;
+            }
+        }
+
+        sLog.outString(">> Voiceover: indexed %u voiced quests in %u zones", (uint32)zoneQuests.size(), (uint32)zoneCount);
+    }
+
+    bool VoiceoverZoneIndex::HasZone(uint32 zoneId) const
+    {
+        auto questIt = std::lower_bound(zoneQuests.begin(), zoneQuests.end(), zoneId, [](const ZoneQuest& zoneQuest, uint32 id) { return zoneQuest.zoneId < id; });
+        return questIt != zoneQuests.end() && questIt->zoneId == zoneId;
+    }
+
+    ZoneQuestHints VoiceoverZoneIndex::GetZoneQuestHints(uint32 zoneId, int localeIndex, size_t maxLength) const
+    {
+        const uint64 key = ((uint64)zoneId << 32) | (uint32)(localeIndex + 1);
+
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto hintsIt = encodedHints.find(key);
+            if (hintsIt != encodedHints.end())
+            {
+                return hintsIt->second;
+            }
+        }
+
+        const auto zoneBegin = std::lower_bound(zoneQuests.begin(), zoneQuests.end(), zoneId, [](const ZoneQuest& zoneQuest, uint32 id) { return zoneQuest.zoneId < id; });
+        const auto zoneEnd = std::upper_bound(zoneBegin, zoneQuests.end(), zoneId, [](uint32 id, const ZoneQuest& zoneQuest) { return id < zoneQuest.zoneId; });
+
+        ZoneQuestHints hints;
+        if (zoneBegin != zoneEnd)
+        {
+            hints = std::make_shared<const std::vector<std::string>>(EncodeZoneQuestHints(zoneId, zoneBegin, zoneEnd, localeIndex, maxLength));
+        }
+
+        // Another thread may have encoded the same zone meanwhile, the first one is kept
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        return encodedHints.emplace(key, hints).first->second;
+    }
+
+    std::vector<std::string> VoiceoverZoneIndex::EncodeZoneQuestHints(uint32 zoneId, ZoneQuestIterator begin, ZoneQuestIterator end, int localeIndex, size_t maxLength)
+    {
+        std::string header = "Z#";
+        AppendBase36(header, zoneId);
+        const size_t maxRecordsLength = maxLength - header.size() - strlen(";00;00#");
+
+        std::vector<std::string> parts;
+        std::string records;
+        std::string record;
+        for (ZoneQuestIterator zoneQuest = begin; zoneQuest != end; ++zoneQuest)
+        {
+            const Quest* quest = sObjectMgr.GetQuestTemplate(zoneQuest->questId);
+            if (!quest)
+            {
+                continue;
+            }
+
+            // questId;starter;ender;questTitle, records that don't fit or would break the message are left out
+            record.clear();
+            AppendBase36(record, zoneQuest->questId);
+            record += ';';
+            AppendQuestGiver(record, AddonProtocol::V2, zoneQuest->starter.type, zoneQuest->starter.entry);
+            record += ';';
+            AppendQuestGiver(record, AddonProtocol::V2, zoneQuest->ender.type, zoneQuest->ender.entry);
+            record += ';';
+            record += VoiceoverQuestIndex::GetQuestTitle(quest, localeIndex);
+            if (record.size() > maxRecordsLength || record.find(ZONE_QUEST_HINT_SEPARATOR) != std::string::npos || record.find('\n') != std::string::npos)
+            {
+                continue;
+            }
+
+            if (!records.empty() && records.size() + 1 + record.size() > maxRecordsLength)
+            {
+                parts.push_back(std::move(records));
+                records.clear();
+            }
+
+            if (!records.empty())
+            {
+                records += ZONE_QUEST_HINT_SEPARATOR;
+            }
+
+            records += record;
+        }
+
+        if (!records.empty())
+        {
+            parts.push_back(std::move(records));
+        }
+
+        std::vector<std::string> messages;
+        messages.reserve(parts.size());
+        for (size_t i = 0; i < parts.size(); ++i)
+        {
+            std::string message = header;
+            message.append(";").append(std::to_string(i + 1)).append(";").append(std::to_string(parts.size())).append("#").append(parts[i]);
+            messages.push_back(std::move(message));
+        }
+
+        return messages;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef CMANGOS_MODULE_VOICEOVER_ZONE_INDEX_H
+#define CMANGOS_MODULE_VOICEOVER_ZONE_INDEX_H
+
+#include "VoiceoverQuestIndex.h"
+
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cmangos_module
+{
+    class VoiceoverVoiceManifest;
+
+    typedef std::shared_ptr<const std::vector<std::string>> ZoneQuestHints;
+
+    // The voiced quests of every zone (or area) with the givers that start and end them, from
+    // the quest sort of the quest templates. It is built at startup and sent to the addon when a
+    // player enters the zone, so the addon finds the quest of a dialog without looking it up.
+    class VoiceoverZoneIndex
+    {
+    public:
+        void Build(const VoiceoverQuestIndex& questIndex, const VoiceoverVoiceManifest& voiceManifest);
+
+        bool HasZone(uint32 zoneId) const;
+        size_t GetZoneCount() const { return zoneCount; }
+        size_t GetQuestCount() const { return zoneQuests.size(); }
+
+        // Z#zoneId;part;parts#questId;starter;ender;questTitle^... in protocol v2, every part at most
+        // maxLength long. The messages only depend on the zone and the locale, they are built once and
+        // kept for as long as the index. Returns nullptr for a zone without voiced quests.
+        ZoneQuestHints GetZoneQuestHints(uint32 zoneId, int localeIndex, size_t maxLength) const;
+
+    private:
+        struct ZoneQuest
+        {
+            uint32 zoneId;
+            uint32 questId;
+            QuestStarter starter;
+            QuestStarter ender;
+
+            bool operator<(const ZoneQuest& other) const { return zoneId < other.zoneId || (zoneId == other.zoneId && questId < other.questId); }
+        };
+
+        typedef std::vector<ZoneQuest>::const_iterator ZoneQuestIterator;
+
+        static std::vector<std::string> EncodeZoneQuestHints(uint32 zoneId, ZoneQuestIterator begin, ZoneQuestIterator end, int localeIndex, size_t maxLength);
+
+    private:
+        // Sorted by zone and quest id, a zone is found with a binary search
+        std::vector<ZoneQuest> zoneQuests;
+        size_t zoneCount = 0;
+
+        mutable std::shared_mutex mutex;
+        mutable std::unordered_map<uint64, ZoneQuestHints> encodedHints;
+    };
+}
+#endif
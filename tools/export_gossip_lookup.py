@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Exports the gossip lookup tables of the VoiceOver data modules for the server.
+
+Reads the GossipLookupByNPCID and GossipLookupByObjectID tables from the .lua files of
+the given data module folders and writes them as "type<TAB>entry<TAB>hash<TAB>text" lines,
+the format expected by the Voiceover.GossipLookupFile option.
+
+Modules are read in the given order and the first one providing a text for an npc or
+object wins, the same priority the addon applies.
+
+Usage: export_gossip_lookup.py output.tsv AI_VoiceOverData_Vanilla [AI_VoiceOverData_...]
+"""
+
+import os
+import re
+import sys
+
+TABLES = {
+    "GossipLookupByNPCID": "npc",
+    "GossipLookupByObjectID": "object",
+}
+
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "\\": "\\", "\"": "\"", "'": "'"}
+
+
+class LuaTableReader:
+    """Minimal reader for the generated {[id] = {["text"] = "hash"}} table literals."""
+
+    def __init__(self, source, pos):
+        self.source = source
+        self.pos = pos
+
+    def skip_space(self):
+        while self.pos < len(self.source):
+            if self.source.startswith("--", self.pos):
+                end = self.source.find("\n", self.pos)
+                self.pos = len(self.source) if end < 0 else end
+            elif self.source[self.pos] in " \t\r\n,;":
+                self.pos += 1
+            else:
+                break
+
+    def expect(self, char):
+        self.skip_space()
+        if self.source[self.pos] != char:
+            raise ValueError("expected '%s' at offset %d" % (char, self.pos))
+        self.pos += 1
+
+    def peek(self):
+        self.skip_space()
+        return self.source[self.pos]
+
+    def read_string(self):
+        self.skip_space()
+        quote = self.source[self.pos]
+        if quote not in "\"'":
+            raise ValueError("expected a string at offset %d" % self.pos)
+        self.pos += 1
+        chars = []
+        while self.source[self.pos] != quote:
+            char = self.source[self.pos]
+            if char == "\\":
+                self.pos += 1
+                char = self.source[self.pos]
+                if char.isdigit():
+                    digits = re.match(r"\d{1,3}", self.source[self.pos:]).group(0)
+                    self.pos += len(digits) - 1
+                    char = chr(int(digits))
+                else:
+                    char = ESCAPES.get(char, char)
+            chars.append(char)
+            self.pos += 1
+        self.pos += 1
+        return "".join(chars)
+
+    def read_number(self):
+        self.skip_space()
+        match = re.compile(r"\d+").match(self.source, self.pos)
+        if not match:
+            raise ValueError("expected a number at offset %d" % self.pos)
+        self.pos = match.end()
+        return int(match.group(0))
+
+    def read_lookup(self):
+        """Reads {[entry] = {["text"] = "hash", ...}, ...} into {entry: {text: hash}}."""
+        lookup = {}
+        self.expect("{")
+        while self.peek() != "}":
+            self.expect("[")
+            entry = self.read_number()
+            self.expect("]")
+            self.expect("=")
+            texts = lookup.setdefault(entry, {})
+            self.expect("{")
+            while self.peek() != "}":
+                self.expect("[")
+                text = self.read_string()
+                self.expect("]")
+                self.expect("=")
+                texts[text] = self.read_string()
+            self.expect("}")
+        self.expect("}")
+        return lookup
+
+
+def read_module(folder):
+    lookups = {}
+    for root, _, files in os.walk(folder):
+        for name in sorted(files):
+            if not name.endswith(".lua"):
+                continue
+            with open(os.path.join(root, name), encoding="utf-8", errors="replace") as file:
+                source = file.read()
+            for table, giver_type in TABLES.items():
+                for match in re.finditer(r"\b%s\s*=\s*" % table, source):
+                    lookup = LuaTableReader(source, match.end()).read_lookup()
+                    for entry, texts in lookup.items():
+                        lookups.setdefault((giver_type, entry), {}).update(texts)
+    return lookups
+
+
+def main(args):
+    if len(args) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    output, folders = args[0], args[1:]
+    merged = {}
+    for folder in folders:
+        for giver, texts in read_module(folder).items():
+            giver_texts = merged.setdefault(giver, {})
+            for text, hash in texts.items():
+                giver_texts.setdefault(text, hash)
+
+    count = 0
+    with open(output, "w", encoding="utf-8", newline="\n") as file:
+        file.write("# type\tentry\thash\ttext\n")
+        for (giver_type, entry), texts in sorted(merged.items()):
+            for text, hash in sorted(texts.items()):
+                # The server reads a line per text, whitespace is not significant when matching
+                text = " ".join(text.split())
+                file.write("%s\t%d\t%s\t%s\n" % (giver_type, entry, hash, text))
+                count += 1
+
+    print("Exported %d gossip texts of %d npcs and objects to %s" % (count, sum(1 for texts in merged.values() if texts), output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Exports the list of voiced quest and gossip lines of the VoiceOver data modules for the server.
+
+Reads the SoundLengthLookupByFileName tables from the .lua files of the given data module
+folders and writes them as "line<TAB>key<TAB>seconds" lines, the format expected by the
+Voiceover.VoiceManifestFile option. Quest lines (accept, progress, complete) are keyed by
+quest id and gossip lines by sound hash, lines recorded for several npcs or genders are
+listed once with their longest length.
+
+Only the data modules installed on the clients should be exported, the server stops sending
+sound events for anything missing from the manifest.
+
+Usage: export_voice_manifest.py output.tsv AI_VoiceOverData_Vanilla [AI_VoiceOverData_...]
+"""
+
+import os
+import re
+import sys
+
+from export_gossip_lookup import LuaTableReader
+
+TABLE = "SoundLengthLookupByFileName"
+QUEST_LINES = ("accept", "progress", "complete")
+
+# [m-|f-]questId-line[-unitId], anything else is a gossip sound hash
+QUEST_FILE_NAME = re.compile(r"^(?:[mf]-)?(\d+)-(accept|progress|complete)(?:-\d+)?$")
+GENDER_PREFIX = re.compile(r"^[mf]-")
+NUMBER = re.compile(r"[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?")
+
+
+def read_lengths(reader):
+    """Reads {["fileName"] = seconds, ...} into {fileName: seconds}."""
+    lengths = {}
+    reader.expect("{")
+    while reader.peek() != "}":
+        reader.expect("[")
+        file_name = reader.read_string()
+        reader.expect("]")
+        reader.expect("=")
+        reader.skip_space()
+        match = NUMBER.match(reader.source, reader.pos)
+        if not match:
+            raise ValueError("expected a number at offset %d" % reader.pos)
+        reader.pos = match.end()
+        lengths[file_name] = float(match.group(0))
+    reader.expect("}")
+    return lengths
+
+
+def read_module(folder):
+    lengths = {}
+    for root, _, files in os.walk(folder):
+        for name in sorted(files):
+            if not name.endswith(".lua"):
+                continue
+            with open(os.path.join(root, name), encoding="utf-8", errors="replace") as file:
+                source = file.read()
+            for match in re.finditer(r"\b%s\s*=\s*" % TABLE, source):
+                lengths.update(read_lengths(LuaTableReader(source, match.end())))
+    return lengths
+
+
+def main(args):
+    if len(args) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    output, folders = args[0], args[1:]
+    lines = {}
+    for folder in folders:
+        for file_name, seconds in read_module(folder).items():
+            match = QUEST_FILE_NAME.match(file_name)
+            if match:
+                key = (match.group(2), int(match.group(1)))
+            else:
+                key = ("gossip", GENDER_PREFIX.sub("", file_name))
+            lines[key] = max(lines.get(key, 0.0), seconds)
+
+    order = {line: index for index, line in enumerate(QUEST_LINES + ("gossip",))}
+    with open(output, "w", encoding="utf-8", newline="\n") as file:
+        file.write("# line\tkey\tseconds\n")
+        for (line, key), seconds in sorted(lines.items(), key=lambda item: (order[item[0][0]], item[0][1])):
+            file.write("%s\t%s\t%.3f\n" % (line, key, seconds))
+
+    quests = len(set(key for line, key in lines if line != "gossip"))
+    gossips = sum(1 for line, _ in lines if line == "gossip")
+    print("Exported %d voiced quest lines of %d quests and %d gossip lines to %s" % (len(lines) - gossips, quests, gossips, output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))